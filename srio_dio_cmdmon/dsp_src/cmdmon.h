@@ -0,0 +1,96 @@
+/*
+ *  cmdmon.h
+ *
+ *  Common declarations of the SRIO Command Monitor shared between
+ *  main.c and the monitor modules (srio_*.c).
+ */
+#ifndef CMDMON_H_
+#define CMDMON_H_
+
+#include <stdint.h>
+#include <ti/csl/csl_srio.h>
+
+/* DSP core clock, used to convert TSC ticks to time */
+#define CPU_FREQ_MHZ		1000
+
+/* SRIO ports loopback mode */
+#define SRIO_LOOPBACK_OFF		0
+#define SRIO_LOOPBACK_DIGITAL	1	/* digital loopback in the SRIO PHY */
+#define SRIO_LOOPBACK_SERDES	2	/* loopback in the SERDES */
+
+/** These are the possible values for SRIO lane mode */
+typedef enum
+{
+  srio_lanes_form_four_1x_ports = 0,             /**< SRIO lanes form four 1x ports */
+  srio_lanes_form_one_2x_port_and_two_1x_ports,  /**< SRIO lanes form one 2x port and two 1x ports */
+  srio_lanes_form_two_1x_ports_and_one_2x_port,  /**< SRIO lanes form two 1x ports and one 2x port */
+  srio_lanes_form_two_2x_ports,                  /**< SRIO lanes form two 2x ports */
+  srio_lanes_form_one_4x_port                    /**< SRIO lanes form one 4x port */
+} srioLanesMode_e;
+
+/* Max secondary device IDs (two base routing registers each, see SrioDevice_setDeviceIds()) */
+#define SRIO_DEVID_MAX		6
+
+/* Entries of the hardware packet forwarding table (see SrioDevice_setForwarding()) */
+#define SRIO_PF_NUM			8
+
+/** Packet forwarding entry: packets to the ID range leave through outPort */
+typedef struct
+{
+	uint16_t	idLo;			/* first destination ID */
+	uint16_t	idUp;			/* last destination ID */
+	uint8_t		outPort;		/* output port */
+	uint8_t		valid;
+} SrioPfEntry;
+
+/* Min period of the background work in long running commands (see cmd_idle()) */
+#define CMD_IDLE_US			1000
+
+/* Max count and length of the command arguments (see parse_args()) */
+#define MAX_ARGS			16
+#define MAX_ARG_LEN			32
+
+typedef int CmdFunc( char *cmdStr );
+typedef struct { char cmd[16]; CmdFunc *func; } CmdEntry;
+
+extern CSL_SrioHandle	hSrio;
+
+extern int				verbose_flag;
+extern int				dbg_flag;
+extern int				loopback_mode;
+extern uint16_t			main_deviceID;
+extern int				id_size;
+extern int				lane_mode;
+extern int				addr_bits;
+extern int				xfer_class;
+extern uint16_t			srio_devid[SRIO_DEVID_MAX];
+extern int				srio_devid_num;
+extern SrioPfEntry		srio_pf[SRIO_PF_NUM];
+
+/* Console output ring (see con_drain()) */
+#define CON_RING_SIZE		0x4000		/* bytes, power of 2 */
+#define CON_LINE_MAX		512			/* max bytes of one printf */
+#define CON_DRAIN_CHUNK		256			/* bytes written per service poll / cmd_idle() */
+
+extern int				con_async;
+extern uint32_t			con_drops;
+extern uint32_t			con_high;
+
+int		dbg_printf( const char *format, ... );
+int		con_printf( const char *format, ... );
+void	con_capture(char *buf, uint32_t size);
+uint32_t	con_capture_end(void);
+void	con_drain(uint32_t max);
+int		cmd_exec(char *cmdbuf);
+void	cmd_idle(void);
+void	cmd_idle_wait(void);
+int		parse_word(char *word, char *cmdbuf);
+int		parse_args(char *cmdStr, char args[][MAX_ARG_LEN], int maxArgs);
+uint8_t	srio_port_mask(int laneMode);
+
+/* Console output goes through con_printf(), so it can be captured
+ * (remote commands, see srio_rpc.c) */
+#undef printf
+#define printf		con_printf
+
+#endif /* CMDMON_H_ */
@@ -76,6 +76,8 @@
 #include <dzy/drv.h>
 #include <prf/sys6678.h>
 
+#include "cmdmon.h"
+
 /**********************************************************************
  ************************* LOCAL Definitions **************************
  **********************************************************************/
@@ -108,33 +110,21 @@
 #define DEVICE_ASSEMBLY_REVISION    0x0
 #define DEVICE_ASSEMBLY_INFO        0x0100
 
+/* SERDES loopback fields of SRIO SERDES CFGRXn / CFGTXn registers */
+#define SERDES_RX_LOOPBACK          0x01800000      /* CFGRX LOOPBACK bits 24:23 */
+#define SERDES_TX_LOOPBACK          0x00600000      /* CFGTX LOOPBACK bits 22:21 */
+/* Lane sync master of the port (set by the lane mode, see setSrioLanes) */
+#define SERDES_TX_MSYNC             0x00100000      /* CFGTX MSYNC bit 20 */
+
 
 /**********************************************************************
  ************************* Extern Definitions *************************
  **********************************************************************/
 
-extern const uint32_t DEVICE_ID1_16BIT;
-extern const uint32_t DEVICE_ID1_8BIT;
-extern const uint32_t DEVICE_ID2_16BIT;
-extern const uint32_t DEVICE_ID2_8BIT;
-extern const uint32_t DEVICE_ID3_16BIT;
-extern const uint32_t DEVICE_ID3_8BIT_ID;
-extern const uint32_t DEVICE_ID4_16BIT;
-extern const uint32_t DEVICE_ID4_8BIT_ID;
 
 /**********************************************************************
  *********************** DEVICE SRIO FUNCTIONS ***********************
  **********************************************************************/
-/** These are the possible values for SRIO lane mode */
-typedef enum
-{
-  srio_lanes_form_four_1x_ports = 0,             /**< SRIO lanes form four 1x ports */
-  srio_lanes_form_one_2x_port_and_two_1x_ports,  /**< SRIO lanes form one 2x port and two 1x ports */
-  srio_lanes_form_two_1x_ports_and_one_2x_port,  /**< SRIO lanes form two 1x ports and one 2x port */
-  srio_lanes_form_two_2x_ports,                  /**< SRIO lanes form two 2x ports */
-  srio_lanes_form_one_4x_port                    /**< SRIO lanes form one 4x port */
-} srioLanesMode_e;
-
 extern	int32_t setSrioLanes (CSL_SrioHandle hSrio, srioLanesMode_e laneMode);
 extern	int32_t displaySrioLanesStatus (CSL_SrioHandle hSrio);
 extern	int32_t waitAllSrioPortsOperational (CSL_SrioHandle hSrio, srioLanesMode_e laneMode);
@@ -143,12 +133,261 @@ extern	int32_t waitAllSrioPortsOperational (CSL_SrioHandle hSrio, srioLanesMode_
  */
 CSL_SrioHandle hSrio;
 //extern	int board_id;
-extern	int main_deviceID;
+extern	uint16_t main_deviceID;
+extern	int id_size;
+extern	int addr_bits;
 extern	int verbose_flag;
 
+/* TX queue scheduling map: output port and priority of each of 16 TX queues.
+ * Changed by 'txq' command of monitor. */
+uint8_t		srio_txq_port[16] = { 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+uint8_t		srio_txq_prio[16] = { 2, 2, 2, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+/* SERDES Rx/Tx configuration per lane set by 'serdes tune' / 'serdes set',
+ * 0 - default of the speed */
+uint32_t	srio_serdes_rx[4] = { 0, 0, 0, 0 };
+uint32_t	srio_serdes_tx[4] = { 0, 0, 0, 0 };
+
+/* Default SERDES Rx/Tx configuration of the speeds 1..4 (1.25, 2.5, 3.125, 5.0 GHz) */
+static const uint32_t	serdesRxCfg[5] = { 0, 0x004404B5, 0x004404A5, 0x00440495, 0x00440495 };
+static const uint32_t	serdesTxCfg[5] = { 0, 0x001807B5, 0x001807A5, 0x00180795, 0x00180795 };
+
+/* Secondary device IDs accepted besides main_deviceID (see 'devid' command) */
+uint16_t	srio_devid[SRIO_DEVID_MAX];
+int			srio_devid_num = 0;
+
+/* Hardware packet forwarding entries (see 'forward' command) */
+SrioPfEntry	srio_pf[SRIO_PF_NUM];
+
 /** @addtogroup SRIO_DEVICE_API
  @{ */
 
+/**
+ *  @b Description
+ *  @n
+ *      The function sets the extended addressing control of the logical
+ *      layer (PE LL Control CSR) for the RapidIO address size.
+ *
+ *  @param[in]  bits
+ *      RapidIO address size: 32, 34, 50 or 66.
+ */
+void SrioDevice_setAddrSize (int bits)
+{
+    /* Extended addressing control: 001 - 34-bit, 010 - 50-bit, 100 - 66-bit */
+    if (bits == 66)
+        CSL_SRIO_SetLLAddressControl (hSrio, 0x4);
+    else if (bits == 50)
+        CSL_SRIO_SetLLAddressControl (hSrio, 0x2);
+    else
+        CSL_SRIO_SetLLAddressControl (hSrio, 0x1);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The function changes the SERDES Rx/Tx configuration of the lanes at
+ *      run time. The loopback bits of the current loopback mode and the
+ *      MSYNC bit of each lane (its role in the port) are kept.
+ *      The function does not wait for the ports to be operational.
+ *
+ *  @param[in]  laneMask
+ *      Lanes to configure (bit n - lane n).
+ *  @param[in]  rx, tx
+ *      SRIO SERDES CFGRX / CFGTX values.
+ */
+void SrioDevice_setSerdes (uint8_t laneMask, uint32_t rx, uint32_t tx)
+{
+    Uint8       bootCompleteFlag;
+    uint32_t    cfg;
+    int32_t     i;
+
+    CSL_SRIO_GetBootComplete (hSrio, &bootCompleteFlag);
+    if (bootCompleteFlag == 1)
+    	/* Set boot complete to be 0; to enable writing to the SRIO registers. */
+		CSL_SRIO_SetBootComplete (hSrio, 0);
+
+    for (i = 0; i < 4; i++)
+    {
+        if (((laneMask >> i) & 1) == 0)
+            continue;
+
+        CSL_BootCfgGetSRIOSERDESRxConfig (i, &cfg);
+        CSL_BootCfgSetSRIOSERDESRxConfig (i, (rx & ~SERDES_RX_LOOPBACK) | (cfg & SERDES_RX_LOOPBACK));
+
+        CSL_BootCfgGetSRIOSERDESTxConfig (i, &cfg);
+        CSL_BootCfgSetSRIOSERDESTxConfig (i, (tx & ~(SERDES_TX_LOOPBACK | SERDES_TX_MSYNC)) |
+                                             (cfg & (SERDES_TX_LOOPBACK | SERDES_TX_MSYNC)));
+    }
+
+    if (bootCompleteFlag == 1)
+		/* Set boot complete back to 1; configuration is complete. */
+		CSL_SRIO_SetBootComplete (hSrio, 1);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The function programs the TLM base routing registers (BRR) so that
+ *      the packets to the main device ID and to every secondary device ID
+ *      (srio_devid[]) are admitted. Each ID takes two BRRs, the 8-bit and
+ *      the 16-bit form; the BRRs are shared by all ports, so the free BRRs
+ *      of all ports are used (BRR 0 of port 0 is not used). The remaining
+ *      BRRs are disabled.
+ *
+ *  @retval
+ *      Success     -   0
+ *  @retval
+ *      Error       -   <0 (too many secondary IDs)
+ */
+int32_t SrioDevice_setDeviceIds (void)
+{
+    Uint8       port = 0, brr = 1;
+    uint16_t    devId, id;
+    uint8_t     id8;
+    int32_t     i, n;
+
+    if (srio_devid_num > SRIO_DEVID_MAX)
+        return -1;
+
+    for (i = 0; i <= srio_devid_num; i++)
+    {
+        devId = (i == 0) ? main_deviceID : srio_devid[i - 1];
+
+        /* With 8-bit IDs the 16-bit ID is formed by duplication of 8-bit ID,
+         * with 16-bit IDs (large system) the 8-bit ID is the low byte. */
+        id8 = devId & 0xFF;
+        id  = (id_size == 0) ? ((id8 << 8) | id8) : devId;
+
+        for (n = 0; n < 2; n++)
+        {
+            CSL_SRIO_SetTLMPortBaseRoutingInfo(hSrio, port, brr, 1, 1, 0);
+            if (n == 0)
+                CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, port, brr, id8, 0xFF);
+            else
+                CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, port, brr, id, 0xFFFF);
+            if (++brr == 4)
+            {
+                brr = 0;
+                port++;
+            }
+        }
+    }
+
+    /* Disable the unused BRRs */
+    for (; port < 4; port++, brr = 0)
+        for (; brr < 4; brr++)
+            CSL_SRIO_SetTLMPortBaseRoutingInfo(hSrio, port, brr, 0, 0, 0);
+
+    return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The function programs the packet forwarding table (srio_pf[]). The
+ *      inbound packets which are not admitted by the BRRs and whose
+ *      destination ID is in the range of an entry are sent out of the
+ *      output port of the entry by the TLM, without the CPU or a memory
+ *      copy. The range is set in both the 16-bit and the 8-bit form; the
+ *      8-bit form only when the range is below 0x100. The entries not used
+ *      or with an output port not formed by the lane mode get an empty
+ *      range (lower bound above the upper bound).
+ *
+ *  @retval
+ *      Number of the active entries
+ */
+int32_t SrioDevice_setForwarding (void)
+{
+    uint8_t         portMask = srio_port_mask(lane_mode);
+    SrioPfEntry     *e;
+    int32_t         i, n = 0;
+
+    for (i = 0; i < SRIO_PF_NUM; i++)
+    {
+        e = &srio_pf[i];
+        if (e->valid == 0 || ((portMask >> e->outPort) & 1) == 0)
+        {
+            hSrio->PF_CNTL[i].RIO_PF_16B_CNTL = CSL_FMK(SRIO_RIO_PF_16B_CNTL_DEVID_16B_UP, 0) |
+                                                CSL_FMK(SRIO_RIO_PF_16B_CNTL_DEVID_16B_LO, 0xFFFF);
+            hSrio->PF_CNTL[i].RIO_PF_8B_CNTL  = CSL_FMK(SRIO_RIO_PF_8B_CNTL_DEVID_8B_UP, 0) |
+                                                CSL_FMK(SRIO_RIO_PF_8B_CNTL_DEVID_8B_LO, 0xFF) |
+                                                CSL_FMK(SRIO_RIO_PF_8B_CNTL_OUT_PORT, 0);
+            continue;
+        }
+
+        hSrio->PF_CNTL[i].RIO_PF_16B_CNTL = CSL_FMK(SRIO_RIO_PF_16B_CNTL_DEVID_16B_UP, e->idUp) |
+                                            CSL_FMK(SRIO_RIO_PF_16B_CNTL_DEVID_16B_LO, e->idLo);
+        if (e->idUp <= 0xFF)
+            hSrio->PF_CNTL[i].RIO_PF_8B_CNTL = CSL_FMK(SRIO_RIO_PF_8B_CNTL_DEVID_8B_UP, e->idUp) |
+                                               CSL_FMK(SRIO_RIO_PF_8B_CNTL_DEVID_8B_LO, e->idLo) |
+                                               CSL_FMK(SRIO_RIO_PF_8B_CNTL_OUT_PORT, e->outPort);
+        else
+            hSrio->PF_CNTL[i].RIO_PF_8B_CNTL = CSL_FMK(SRIO_RIO_PF_8B_CNTL_DEVID_8B_UP, 0) |
+                                               CSL_FMK(SRIO_RIO_PF_8B_CNTL_DEVID_8B_LO, 0xFF) |
+                                               CSL_FMK(SRIO_RIO_PF_8B_CNTL_OUT_PORT, e->outPort);
+        n++;
+    }
+    return n;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      The function switches all SRIO ports to the loopback mode at run time
+ *      and waits for the ports to be operational.
+ *
+ *  @param[in]  mode
+ *      SRIO_LOOPBACK_OFF, SRIO_LOOPBACK_DIGITAL or SRIO_LOOPBACK_SERDES.
+ *
+ *  @retval
+ *      Success     -   0
+ *  @retval
+ *      Error       -   <0 (invalid mode)
+ */
+int32_t SrioDevice_setLoopback (int mode)
+{
+    Uint8       bootCompleteFlag;
+    uint32_t    cfg;
+    int32_t     i;
+
+    if (mode != SRIO_LOOPBACK_OFF && mode != SRIO_LOOPBACK_DIGITAL && mode != SRIO_LOOPBACK_SERDES)
+        return -1;
+
+    CSL_SRIO_GetBootComplete (hSrio, &bootCompleteFlag);
+    if (bootCompleteFlag == 1)
+    	/* Set boot complete to be 0; to enable writing to the SRIO registers. */
+		CSL_SRIO_SetBootComplete (hSrio, 0);
+
+    for (i = 0; i < 4; i++)
+    {
+        if (mode == SRIO_LOOPBACK_DIGITAL)
+            CSL_SRIO_SetLoopbackMode(hSrio, i);
+        else
+            CSL_SRIO_SetNormalMode(hSrio, i);
+
+        CSL_BootCfgGetSRIOSERDESRxConfig (i, &cfg);
+        if (mode == SRIO_LOOPBACK_SERDES)   cfg |= SERDES_RX_LOOPBACK;
+        else                                cfg &= ~SERDES_RX_LOOPBACK;
+        CSL_BootCfgSetSRIOSERDESRxConfig (i, cfg);
+
+        CSL_BootCfgGetSRIOSERDESTxConfig (i, &cfg);
+        if (mode == SRIO_LOOPBACK_SERDES)   cfg |= SERDES_TX_LOOPBACK;
+        else                                cfg &= ~SERDES_TX_LOOPBACK;
+        CSL_BootCfgSetSRIOSERDESTxConfig (i, cfg);
+    }
+
+    if (bootCompleteFlag == 1)
+		/* Set boot complete back to 1; configuration is complete. */
+		CSL_SRIO_SetBootComplete (hSrio, 1);
+
+    loopback_mode = mode;
+
+    /* Check Ports and make sure they are operational. */
+    waitAllSrioPortsOperational(hSrio, lane_mode);
+
+    return 0;
+}
+
 /**
  *  @b Description
  *  @n  
@@ -202,17 +441,14 @@ int32_t SrioDevice_init (int speed)
     for(i = 0; i <= 9; i++)
         CSL_SRIO_EnableBlock(hSrio,i);
 
-    /* Configure SRIO ports to operate in loopback mode. */
-/*
-    CSL_SRIO_SetLoopbackMode(hSrio, 0);
-    CSL_SRIO_SetLoopbackMode(hSrio, 1);
-    CSL_SRIO_SetLoopbackMode(hSrio, 2);
-    CSL_SRIO_SetLoopbackMode(hSrio, 3);
-	*/
-    CSL_SRIO_SetNormalMode(hSrio, 0);
-    CSL_SRIO_SetNormalMode(hSrio, 1);
-    CSL_SRIO_SetNormalMode(hSrio, 2);
-    CSL_SRIO_SetNormalMode(hSrio, 3);
+    /* Configure SRIO ports to operate in digital loopback or normal mode. */
+    for (i = 0; i < 4; i++)
+    {
+        if (loopback_mode == SRIO_LOOPBACK_DIGITAL)
+            CSL_SRIO_SetLoopbackMode(hSrio, i);
+        else
+            CSL_SRIO_SetNormalMode(hSrio, i);
+    }
 
 	/* Enable Automatic Priority Promotion of response packets. */
 	CSL_SRIO_EnableAutomaticPriorityPromotion(hSrio);
@@ -230,51 +466,28 @@ int32_t SrioDevice_init (int speed)
     if(speed == 1)		CSL_BootCfgSetSRIOSERDESConfigPLL (0x281);	// 1.25
     else 				CSL_BootCfgSetSRIOSERDESConfigPLL (0x251);	// 2.5, 3.125, 5.0
 
-    /* Configure the SRIO SERDES Receive Configuration. */
-    if(speed == 1) {	// 1.25 GHz
-		CSL_BootCfgSetSRIOSERDESRxConfig (0, 0x004404B5);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (1, 0x004404B5);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (2, 0x004404B5);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (3, 0x004404B5);//0x00440495);
-
-		/* Configure the SRIO SERDES Transmit Configuration. */
-		CSL_BootCfgSetSRIOSERDESTxConfig (0, 0x001807B5);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (1, 0x001807B5);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (2, 0x001807B5);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (3, 0x001807B5);//0x00180795);
-    } else if(speed == 2) {	// 2.5 GHz
-		CSL_BootCfgSetSRIOSERDESRxConfig (0, 0x004404A5);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (1, 0x004404A5);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (2, 0x004404A5);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (3, 0x004404A5);//0x00440495);
-
-		/* Configure the SRIO SERDES Transmit Configuration. */
-		CSL_BootCfgSetSRIOSERDESTxConfig (0, 0x001807A5);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (1, 0x001807A5);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (2, 0x001807A5);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (3, 0x001807A5);//0x00180795);
-    } else if(speed == 3) {	// 3.125 GHz
-		CSL_BootCfgSetSRIOSERDESRxConfig (0, 0x00440495);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (1, 0x00440495);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (2, 0x00440495);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (3, 0x00440495);//0x00440495);
-
-		/* Configure the SRIO SERDES Transmit Configuration. */
-		CSL_BootCfgSetSRIOSERDESTxConfig (0, 0x00180795);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (1, 0x00180795);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (2, 0x00180795);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (3, 0x00180795);//0x00180795);
-    } else if(speed == 4) {	// 5.0 GHz
-		CSL_BootCfgSetSRIOSERDESRxConfig (0, 0x00440495);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (1, 0x00440495);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (2, 0x00440495);//0x00440495);
-		CSL_BootCfgSetSRIOSERDESRxConfig (3, 0x00440495);//0x00440495);
-
-		/* Configure the SRIO SERDES Transmit Configuration. */
-		CSL_BootCfgSetSRIOSERDESTxConfig (0, 0x00180795);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (1, 0x00180795);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (2, 0x00180795);//0x00180795);
-		CSL_BootCfgSetSRIOSERDESTxConfig (3, 0x00180795);//0x00180795);
+    /* Configure the SRIO SERDES Receive and Transmit Configuration: the tuned
+     * values of the lane (see 'serdes tune') or the defaults of the speed. */
+    if (speed >= 1 && speed <= 4)
+    {
+        for (i = 0; i < 4; i++)
+        {
+            CSL_BootCfgSetSRIOSERDESRxConfig (i, srio_serdes_rx[i] ? srio_serdes_rx[i] : serdesRxCfg[speed]);
+            CSL_BootCfgSetSRIOSERDESTxConfig (i, srio_serdes_tx[i] ? srio_serdes_tx[i] : serdesTxCfg[speed]);
+        }
+    }
+
+    /* SERDES loopback: the serial data is looped inside the SERDES of each lane */
+    if (loopback_mode == SRIO_LOOPBACK_SERDES)
+    {
+        uint32_t    cfg;
+        for (i = 0; i < 4; i++)
+        {
+            CSL_BootCfgGetSRIOSERDESRxConfig (i, &cfg);
+            CSL_BootCfgSetSRIOSERDESRxConfig (i, cfg | SERDES_RX_LOOPBACK);
+            CSL_BootCfgGetSRIOSERDESTxConfig (i, &cfg);
+            CSL_BootCfgSetSRIOSERDESTxConfig (i, cfg | SERDES_TX_LOOPBACK);
+        }
     }
 
 
@@ -343,12 +556,15 @@ int32_t SrioDevice_init (int speed)
     peFeatures.isExtendedRouteConfigSupported    = 0;
     peFeatures.isStandardRouteConfigSupported    = 1;
     peFeatures.isFlowControlSupported            = 1;
-    peFeatures.isCRFSupported                    = 0;
+    peFeatures.isCRFSupported                    = 1;
     peFeatures.isCTLSSupported                   = 1;
     peFeatures.isExtendedFeaturePtrValid         = 1;
-    peFeatures.numAddressBitSupported            = 1;
+    peFeatures.numAddressBitSupported            = 7;		// 66, 50 and 34-bit addresses
     CSL_SRIO_SetProcessingElementFeatures (hSrio, &peFeatures);
 
+    /* Select the address size used by the logical layer */
+    SrioDevice_setAddrSize (addr_bits);
+
     /* Configure the source operation CAR */
     memset ((void *) &opCar, 0, sizeof (opCar));
     opCar.portWriteOperationSupport = 1;
@@ -383,37 +599,22 @@ int32_t SrioDevice_init (int speed)
     else if(board_id == 2)
     	CSL_SRIO_SetDeviceIDCSR (hSrio, DEVICE_ID2_8BIT, DEVICE_ID2_16BIT);
 */
-    uint16_t	id = main_deviceID;
-    id<<=8;
-    id|=main_deviceID;
-    CSL_SRIO_SetDeviceIDCSR (hSrio, main_deviceID, id);
-
-    /* Enable TLM Base Routing Information for Maintainance Requests & ensure that
-     * the BRR's can be used by all the ports. */
-    CSL_SRIO_SetTLMPortBaseRoutingInfo(hSrio, 0, 1, 1, 1, 0);
-    CSL_SRIO_SetTLMPortBaseRoutingInfo(hSrio, 0, 2, 1, 1, 0);
-    CSL_SRIO_SetTLMPortBaseRoutingInfo(hSrio, 0, 3, 1, 1, 0);
-    CSL_SRIO_SetTLMPortBaseRoutingInfo(hSrio, 1, 0, 1, 1, 0);
-
-    /* Configure the Base Routing Register to ensure that all packets matching the 
-     * Device Identifier & the Secondary Device Id are admitted. */
-/*    if(board_id == 1) {
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 1, DEVICE_ID2_16BIT, 0xFFFF);
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 2, DEVICE_ID3_16BIT, 0xFFFF);
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 3, DEVICE_ID4_16BIT, 0xFFFF);
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 1, 0, DEVICE_ID2_8BIT,  0xFF);
-    }
-    else if(board_id == 2) {
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 1, DEVICE_ID1_16BIT, 0xFFFF);
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 2, DEVICE_ID3_16BIT, 0xFFFF);
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 3, DEVICE_ID4_16BIT, 0xFFFF);
-		CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 1, 0, DEVICE_ID1_8BIT,  0xFF);
+    /* With 8-bit main ID the 16-bit ID is formed by duplication of 8-bit ID,
+     * with 16-bit main ID (large system) the 8-bit ID is its low byte. */
+    uint8_t		id8 = main_deviceID & 0xFF;
+    uint16_t	id  = main_deviceID;
+    if (id_size == 0) {
+        id<<=8;
+        id|=id8;
     }
-*/
-	CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 1, id, 0xFFFF);
-	CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 2, DEVICE_ID3_16BIT, 0xFFFF);
-	CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 0, 3, DEVICE_ID4_16BIT, 0xFFFF);
-	CSL_SRIO_SetTLMPortBaseRoutingPatternMatch(hSrio, 1, 0, main_deviceID,  0xFF);
+    CSL_SRIO_SetDeviceIDCSR (hSrio, id8, id);
+
+    /* Configure the Base Routing Registers to ensure that all packets matching the
+     * main Device Identifier & the secondary Device Ids are admitted on every port. */
+    SrioDevice_setDeviceIds ();
+
+    /* Relay the packets of the other boards (pass-through board) */
+    SrioDevice_setForwarding ();
 
 
     #if 0
@@ -498,7 +699,7 @@ int32_t SrioDevice_init (int speed)
     /* Configuration has been completed. */
     CSL_SRIO_SetBootComplete(hSrio, 1);
 
-    setSrioLanes (hSrio, srio_lanes_form_one_4x_port);
+    setSrioLanes (hSrio, lane_mode);
    	/* SRIO Driver is operational at this time. */
     displaySrioLanesStatus (hSrio);
 
@@ -513,14 +714,14 @@ int32_t SrioDevice_init (int speed)
 //#endif
 
     /* Check Ports and make sure they are operational. */
-	if (waitAllSrioPortsOperational(hSrio, srio_lanes_form_one_4x_port) < 0)
+	if (waitAllSrioPortsOperational(hSrio, lane_mode) < 0)
 		return -1;
 
 	if(verbose_flag!=0) printf("SRIO IsPortOk\n");
 
-    /* Set all the queues 0 to operate at the same priority level and to send packets onto Port 0 */
+    /* Set the queues output port and priority from the TX queue map */
     for (i =0 ; i < 16; i++)
-        CSL_SRIO_SetTxQueueSchedInfo(hSrio, i, 0, 0);
+        CSL_SRIO_SetTxQueueSchedInfo(hSrio, i, srio_txq_port[i], srio_txq_prio[i]);
 
     /* Set the Doorbell route to determine which routing table is to be used 
      * This configuration implies that the Interrupt Routing Table is configured as 
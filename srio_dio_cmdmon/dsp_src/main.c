@@ -23,33 +23,58 @@
 #include <dzy/drv.h>
 #include <prf/sys6678.h>
 
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_trace.h"
+#include "srio_bench.h"
+#include "srio_event.h"
+#include "srio_link.h"
+#include "srio_async.h"
+#include "srio_snap.h"
+#include "srio_sg.h"
+#include "srio_prbs.h"
+#include "srio_ring.h"
+#include "srio_rpc.h"
+#include "srio_route.h"
+#include "srio_serdes.h"
+#include "srio_tsync.h"
+#include "srio_load.h"
+
 #define MAX_MSG_LEN 128
 
-extern CSL_SrioHandle      hSrio;
 extern SrioDevice_init();
 
-/* These are the device identifiers used in the Example Application */
-const uint32_t DEVICE_ID1_16BIT    = 0xBEEF;
-const uint32_t DEVICE_ID1_8BIT     = 0xAB;
-const uint32_t DEVICE_ID2_16BIT    = 0x4560;
-const uint32_t DEVICE_ID2_8BIT     = 0xCD;
-const uint32_t DEVICE_ID3_16BIT    = 0x1234;
-const uint32_t DEVICE_ID3_8BIT     = 0x12;
-const uint32_t DEVICE_ID4_16BIT    = 0x5678;
-const uint32_t DEVICE_ID4_8BIT     = 0x56;
-
-/** These are the possible values for SRIO lane mode */
-typedef enum
-{
-  srio_lanes_form_four_1x_ports = 0,             /**< SRIO lanes form four 1x ports */
-  srio_lanes_form_one_2x_port_and_two_1x_ports,  /**< SRIO lanes form one 2x port and two 1x ports */
-  srio_lanes_form_two_1x_ports_and_one_2x_port,  /**< SRIO lanes form two 1x ports and one 2x port */
-  srio_lanes_form_two_2x_ports,                  /**< SRIO lanes form two 2x ports */
-  srio_lanes_form_one_4x_port                    /**< SRIO lanes form one 4x port */
-} srioLanesMode_e;
-
 int verbose_flag = 0;
 
+/**
+ *  @b Description
+ *  @n
+ *      Get the mask of the ports formed by the lane mode.
+ *
+ *  @param[in]  laneMode
+ *      SRIO lane mode.
+ *
+ *  @retval
+ *      Ports mask (bit N - port N)
+ */
+uint8_t srio_port_mask (int laneMode)
+{
+	switch (laneMode)
+	{
+		case srio_lanes_form_four_1x_ports:					/* ports 0 to 3 */
+			return 0xF;	// 0b1111
+		case srio_lanes_form_one_2x_port_and_two_1x_ports:	/* ports 0, 2, and 3 */
+			return 0xD;	// 0b1101
+		case srio_lanes_form_two_1x_ports_and_one_2x_port:	/* ports 0, 1, and 2 */
+			return 0x7;	// 0b0111
+		case srio_lanes_form_two_2x_ports:					/* ports 0 and 2 */
+			return 0x5;	// 0b0101
+		case srio_lanes_form_one_4x_port:					/* port 0 */
+			return 0x1;	// 0b0001
+	}
+	return 0xF;	// 0b1111
+}
+
 /**
  *  @b Description
  *  @n
@@ -71,27 +96,7 @@ int32_t waitAllSrioPortsOperational (CSL_SrioHandle hSrio, srioLanesMode_e laneM
     uint64_t	tscTemp;
 
     /* Set port mask to use based on the lane mode specified */
-	switch (laneMode)
-	{
-		case srio_lanes_form_four_1x_ports:					/* check ports 0 to 3 */
-			portsMask = 0xF;	// 0b1111
-			break;
-		case srio_lanes_form_one_2x_port_and_two_1x_ports:	/* check ports 0, 2, and 3 */
-			portsMask = 0xD;	// 0b1101
-			break;
-		case srio_lanes_form_two_1x_ports_and_one_2x_port:	/* check ports 0, 1, and 2 */
-			portsMask = 0x7;	// 0b0111
-			break;
-		case srio_lanes_form_two_2x_ports:					/* check ports 0 and 2 */
-			portsMask = 0x5;	// 0b0101
-			break;
-		case srio_lanes_form_one_4x_port:					/* check port 0 */
-			portsMask = 0x1;	// 0b0001
-			break;
-		default: /* check ports 0 to 3 */
-			portsMask = 0xF;	// 0b1111
-			break;
-	}
+	portsMask = srio_port_mask (laneMode);
 
     /* Wait for all SRIO ports for specified lane mode to be operational */
 	if( verbose_flag) printf ("Debug: Waiting for SRIO ports to be operational...  \n");
@@ -313,7 +318,11 @@ int32_t setSrioLanes (CSL_SrioHandle hSrio, srioLanesMode_e laneMode)
     return 0;
 }
 
-uint8_t		main_deviceID = 0;
+uint16_t	main_deviceID = 0;
+int			id_size = SRIO_ID_8BIT;		// device ID size: 0 - 8bit, 1 - 16bit (large system)
+int			addr_bits = SRIO_ADDR_32;	// RapidIO address size of nread/nwrite
+int			loopback_mode = SRIO_LOOPBACK_OFF;
+int			lane_mode = srio_lanes_form_one_4x_port;
 
 //int read_flag = 0;
 //int write_flag = 0;
@@ -332,7 +341,8 @@ uint8_t	dest_id = 0;
 uint8_t	ttype = 0;
 uint8_t	ftype = 0;
 uint8_t	hop_count = 0;
-uint32_t LSU = 0;
+int		lsu_fixed = -1;					// LSU set by 'lsu' command (-1 - select by class)
+int		xfer_class = SRIO_CLASS_CTRL;	// priority class of monitor commands
 volatile uint32_t SRC = 0x10860000;		// address of src
 
 volatile uint32_t dest_adr = 0; 	// address of dest
@@ -343,10 +353,79 @@ void	print_usage(void)
 	printf("SRIO Command Monitor Application for C6678 modules\n");
 	printf("Keys:  -h, -H, -?            -- this message\n");
 	printf("       -d<DD>, -D<DD>        -- main SRIO Device ID DD(hex-8bit)\n");
+	printf("       -d<DDDD>, -D<DDDD>    -- main SRIO Device ID DDDD(hex-16bit), large system\n");
 	printf("       -b<N>, -B<N>          -- board id N (dec)\n");
+	printf("       -L, -Ls               -- digital or SERDES loopback mode\n");
+	printf("       -p<N>, -P<N>          -- lane mode N: 0 - four 1x, 1 - 2x+1x+1x, 2 - 1x+1x+2x,\n");
+	printf("                                3 - two 2x, 4 - one 4x (default)\n");
+	printf("       -r, -R                -- serve remote commands only (no console)\n");
+	printf("       -s<ID>[,<ID>...]      -- secondary SRIO Device IDs (hex, max %d)\n", SRIO_DEVID_MAX);
 	printf("       -v, -V                -- verbose\n");
 }
 
+/*********************** console output ring ********************
+* With con_async on, the console output is formatted into con_ring and
+* written to the host stdio by con_drain(): between the commands, from
+* service_poll() and in bounded chunks from cmd_idle() of the long running
+* commands, never from an LSU wait, so the host I/O doesn't stall the
+* transfers. A message that doesn't fit into the ring is dropped and counted.
+****************************************************/
+static char		con_ring[CON_RING_SIZE];
+static char		con_line[CON_LINE_MAX];
+static uint32_t	con_head, con_tail;		/* bytes drained / written, free running */
+int				con_async = 0;		/* turned on by the command loop */
+uint32_t		con_drops;				/* messages dropped, ring full */
+uint32_t		con_high;				/* max ring use (bytes) */
+
+static int	con_vput(const char *format, va_list arglist)
+{
+	uint32_t	len, used, ofs, n;
+	int			ret;
+
+	if(con_async == 0)
+		return vfprintf( stdout, format, arglist );
+
+	ret = vsnprintf( con_line, CON_LINE_MAX, format, arglist );
+	if(ret <= 0) return ret;
+	len  = (ret < CON_LINE_MAX) ? ret : CON_LINE_MAX - 1;
+	used = con_tail - con_head;
+	if(used + len > CON_RING_SIZE) {
+		con_drops++;
+		return ret;
+	}
+	ofs = con_tail & (CON_RING_SIZE - 1);
+	n   = (len < CON_RING_SIZE - ofs) ? len : CON_RING_SIZE - ofs;
+	memcpy(&con_ring[ofs], con_line, n);
+	memcpy(&con_ring[0], con_line + n, len - n);
+	con_tail += len;
+	if(used + len > con_high) con_high = used + len;
+	return ret;
+}
+
+/*********************** con_drain ********************
+* Write up to max bytes of the console ring to the host (0 - all)
+****************************************************/
+void	con_drain(uint32_t max)
+{
+	uint32_t	ofs, n, drops;
+	static uint32_t	dropsShown;
+
+	if(max == 0) max = CON_RING_SIZE;
+	while(max && con_tail != con_head) {
+		ofs = con_head & (CON_RING_SIZE - 1);
+		n   = con_tail - con_head;
+		if(n > CON_RING_SIZE - ofs) n = CON_RING_SIZE - ofs;
+		if(n > max) n = max;
+		fwrite(&con_ring[ofs], 1, n, stdout);
+		con_head += n;
+		max -= n;
+	}
+	if(con_tail == con_head && (drops = con_drops) != dropsShown) {
+		fprintf(stdout, "### console: %lu messages dropped\n", drops - dropsShown);
+		dropsShown = drops;
+	}
+}
+
 /*********************** dbg_printf ********************
 ****************************************************/
 int     dbg_printf( const char *format, ... )
@@ -357,18 +436,57 @@ int     dbg_printf( const char *format, ... )
 	int		ret;
 
 	va_start( arglist, format );
-	ret = vfprintf( stdout, format, arglist );
+	ret = con_vput( format, arglist );
 	va_end(arglist);
 	return ret;
 }
 
+/*********************** con_printf ********************
+* Console output, into the capture buffer while capturing
+****************************************************/
+static char		*con_buf = NULL;
+static uint32_t	con_size, con_len;
+
+int     con_printf( const char *format, ... )
+{
+	va_list arglist;
+	int		ret;
+
+	va_start( arglist, format );
+	if(con_buf) {
+		ret = vsnprintf( con_buf + con_len, con_size - con_len, format, arglist );
+		if(ret > 0) con_len += (con_len + ret < con_size) ? ret : con_size - 1 - con_len;
+	}
+	else
+		ret = con_vput( format, arglist );
+	va_end(arglist);
+	return ret;
+}
+
+/*********************** con_capture ********************
+* Start capture of the console output into buf
+****************************************************/
+void	con_capture(char *buf, uint32_t size)
+{
+	buf[0]   = 0;
+	con_size = size;
+	con_len  = 0;
+	con_buf  = buf;
+}
+
+/*********************** con_capture_end ********************
+* Stop capture, return length of the captured output
+****************************************************/
+uint32_t	con_capture_end(void)
+{
+	con_buf = NULL;
+	return con_len;
+}
+
 ///////////////////////////////////////////////////////////////
 // Command functions
 ///////////////////////////////////////////////////////////////
 
-typedef int CmdFunc( char *cmdStr );
-typedef struct { char cmd[16]; CmdFunc *func; } CmdEntry;
-
 int	parse_word(char *word, char *cmdbuf)
 {
 	int i; 			// cmdbuf counter
@@ -389,6 +507,27 @@ int	parse_word(char *word, char *cmdbuf)
 	return i;
 }
 
+/*********************** parse_args ********************
+* Split command string to space separated arguments.
+* Return number of arguments.
+****************************************************/
+int	parse_args(char *cmdStr, char args[][MAX_ARG_LEN], int maxArgs)
+{
+	int		argc = 0;
+	int		k;
+	char	*p = cmdStr;
+
+	while(argc < maxArgs) {
+		while(*p == ' ' || *p == '\t') p++;
+		if(*p == 0 || *p == '\r' || *p == '\n') break;
+		for(k=0; *p && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n'; p++)
+			if(k < MAX_ARG_LEN-1) args[argc][k++] = *p;
+		args[argc][k] = 0;
+		argc++;
+	}
+	return argc;
+}
+
 int rdFunc(char *cmdStr)
 {
 	dbg_printf("RD: %s\n", cmdStr);
@@ -527,6 +666,7 @@ int fillFunc(char *cmdStr)
 int	quitFunc(char *cmdStr)
 {
 	dbg_printf("QUIT\n");
+	con_drain(0);
 	exit(0);
 	return 0;
 }
@@ -540,6 +680,32 @@ int dbgFunc(char *cmdStr)
 	return 0;
 }
 
+int conFunc(char *cmdStr)
+{
+	dbg_printf("CONSOLE: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+
+	if(parse_args(cmdStr, args, MAX_ARGS) > 0) {
+		if(strcmp(args[0], "async") == 0)		con_async = 1;
+		else if(strcmp(args[0], "sync") == 0) {
+			con_drain(0);
+			con_async = 0;
+		}
+		else if(strcmp(args[0], "clr") == 0) {
+			con_drops = 0;
+			con_high  = 0;
+		}
+		else {
+			printf("### conFunc: bad arguments '%s'\n", cmdStr);
+			return -1;
+		}
+	}
+	printf("CONSOLE: %s, ring %d bytes, max use %lu, %lu messages dropped\n",
+		con_async ? "async" : "sync", CON_RING_SIZE, con_high, con_drops);
+	return 0;
+}
+
 int hopFunc(char *cmdStr)
 {
 	dbg_printf("HOP_COUNT: %s\n", cmdStr);
@@ -565,20 +731,454 @@ int lsuFunc(char *cmdStr)
 	char		str[128];
 
 	if( (parse_word(str,cmdStr)) < 0) {
-		printf("### rdFunc: parse_word(,'%s') error\n", cmdStr);
+		printf("### lsuFunc: parse_word(,'%s') error\n", cmdStr);
 		return -1;
 	}
+	if(strcmp(str, "auto") == 0) {
+		lsu_fixed = -1;
+		printf("LSU: selected by class\n");
+		return 0;
+	}
 	val = atol(str);
+	if(val >= SRIO_LSU_NUM) {
+		printf("### lsuFunc: bad LSU number %d\n", val);
+		return -1;
+	}
+	lsu_fixed = val;
 	printf("LSU: value = %d\n", val);
 	return 0;
 }
 
+/*********************** cmd_lsu ********************
+* LSU for the monitor command transaction
+****************************************************/
+static uint8_t	cmd_lsu(void)
+{
+	if(lsu_fixed >= 0) return lsu_fixed;
+	return srio_lsu_select(xfer_class);
+}
+
+/*********************** class_name ********************
+****************************************************/
+static const char	*class_name(int cls)
+{
+	return (cls == SRIO_CLASS_CTRL) ? "ctrl" : "bulk";
+}
+
+static int	class_parse(const char *str)
+{
+	if(strcmp(str, "ctrl") == 0) return SRIO_CLASS_CTRL;
+	if(strcmp(str, "bulk") == 0) return SRIO_CLASS_BULK;
+	return -1;
+}
+
+///////////////////////////////////////////////////////////////
+////////// classFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int classFunc(char *cmdStr)
+{
+	dbg_printf("CLASS: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			cls;
+
+	if(parse_args(cmdStr, args, MAX_ARGS) > 0) {
+		if( (cls=class_parse(args[0])) < 0) {
+			printf("### classFunc: bad class '%s'\n", args[0]);
+			return -1;
+		}
+		xfer_class = cls;
+	}
+	printf("CLASS: %s (priority %d, CRF %d, LSU mask 0x%02X)\n", class_name(xfer_class),
+		srio_class_cfg[xfer_class].priority, srio_class_cfg[xfer_class].crf,
+		srio_class_cfg[xfer_class].lsuMask);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// prioFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int prioFunc(char *cmdStr)
+{
+	dbg_printf("PRIO: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, cls;
+	uint32_t	prio, crf, mask;
+	char		*end;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc >= 4) {
+		if( (cls=class_parse(args[0])) < 0) {
+			printf("### prioFunc: bad class '%s'\n", args[0]);
+			return -1;
+		}
+		prio = strtoul(args[1], &end, 10);
+		crf  = strtoul(args[2], &end, 10);
+		mask = strtoul(args[3], &end, 16);
+		if(prio > SRIO_PRIO_MAX || crf > 1 || mask == 0 || mask > 0xFF) {
+			printf("### prioFunc: bad value (priority 0..%d, CRF 0..1, LSU mask 01..FF)\n", SRIO_PRIO_MAX);
+			return -1;
+		}
+		srio_class_cfg[cls].priority = prio;
+		srio_class_cfg[cls].crf      = crf;
+		srio_class_cfg[cls].lsuMask  = mask;
+	}
+	else if(argc != 0) {
+		printf("### prioFunc: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	for(cls=0; cls<SRIO_CLASS_NUM; cls++)
+		printf("PRIO: %s priority %d, CRF %d, LSU mask 0x%02X\n", class_name(cls),
+			srio_class_cfg[cls].priority, srio_class_cfg[cls].crf, srio_class_cfg[cls].lsuMask);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// retryFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int retryFunc(char *cmdStr)
+{
+	dbg_printf("RETRY: %s\n", cmdStr);
+
+	char			args[MAX_ARGS][MAX_ARG_LEN];
+	int				argc;
+	SrioXferPolicy	p = srio_xfer_policy;
+	char			*end;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc > 0 && strcmp(args[0], "clr") == 0) {
+		srio_xfer_retried = 0;
+		srio_xfer_failed  = 0;
+		argc = 0;
+	}
+	if(argc > 0) p.timeoutUs	= strtoul(args[0], &end, 10);
+	if(argc > 1) p.retries		= strtoul(args[1], &end, 10);
+	if(argc > 2) p.backoffUs	= strtoul(args[2], &end, 10);
+	if(argc > 3) p.backoffMaxUs	= strtoul(args[3], &end, 10);
+	if(p.timeoutUs == 0 || p.backoffMaxUs < p.backoffUs) {
+		printf("### retryFunc: bad value (timeout > 0, max backoff >= backoff)\n");
+		return -1;
+	}
+	srio_xfer_policy = p;
+
+	printf("RETRY: timeout %lu us, %lu retries, backoff %lu..%lu us\n",
+		p.timeoutUs, p.retries, p.backoffUs, p.backoffMaxUs);
+	printf("RETRY: %lu retries done, %lu failed transactions\n", srio_xfer_retried, srio_xfer_failed);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// idsizeFunc() ///////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int idsizeFunc(char *cmdStr)
+{
+	dbg_printf("IDSIZE: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+
+	if(parse_args(cmdStr, args, MAX_ARGS) > 0) {
+		if(strcmp(args[0], "8") == 0)			id_size = SRIO_ID_8BIT;
+		else if(strcmp(args[0], "16") == 0)		id_size = SRIO_ID_16BIT;
+		else {
+			printf("### idsizeFunc: bad ID size '%s' (8 or 16)\n", args[0]);
+			return -1;
+		}
+	}
+	printf("IDSIZE: %s-bit device IDs\n", id_size ? "16" : "8");
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// devidFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+extern int32_t	SrioDevice_setDeviceIds(void);
+
+int devidFunc(char *cmdStr)
+{
+	dbg_printf("DEVID: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i;
+	uint32_t	id;
+	char		*end;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc >= 2 && strcmp(args[0], "add") == 0) {
+		id = strtoul(args[1], &end, 16);
+		if(id_size == SRIO_ID_8BIT && id > 0xFF) {
+			printf("### devidFunc: ID 0x%lX is too large for 8-bit ID size (see 'idsize')\n", id);
+			return -1;
+		}
+		for(i=0; i<srio_devid_num; i++)
+			if(srio_devid[i] == id) break;
+		if(id == main_deviceID || i < srio_devid_num) {
+			printf("### devidFunc: ID 0x%lX is already accepted\n", id);
+			return -1;
+		}
+		if(srio_devid_num == SRIO_DEVID_MAX) {
+			printf("### devidFunc: max %d secondary IDs\n", SRIO_DEVID_MAX);
+			return -1;
+		}
+		srio_devid[srio_devid_num++] = id;
+		SrioDevice_setDeviceIds();
+	}
+	else if(argc >= 2 && strcmp(args[0], "del") == 0) {
+		if(strcmp(args[1], "all") == 0)
+			srio_devid_num = 0;
+		else {
+			id = strtoul(args[1], &end, 16);
+			for(i=0; i<srio_devid_num; i++)
+				if(srio_devid[i] == id) break;
+			if(i == srio_devid_num) {
+				printf("### devidFunc: ID 0x%lX is not a secondary ID\n", id);
+				return -1;
+			}
+			for(; i<srio_devid_num-1; i++)
+				srio_devid[i] = srio_devid[i+1];
+			srio_devid_num--;
+		}
+		SrioDevice_setDeviceIds();
+	}
+	else if(argc > 0) {
+		printf("### devidFunc: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	printf("DEVID: main 0x%0*X", id_size ? 4 : 2, main_deviceID);
+	for(i=0; i<srio_devid_num; i++)
+		printf(", 0x%0*X", id_size ? 4 : 2, srio_devid[i]);
+	printf("\n");
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// forwardFunc() //////////////////////////////////////
+///////////////////////////////////////////////////////////////
+extern int32_t	SrioDevice_setForwarding(void);
+
+int forwardFunc(char *cmdStr)
+{
+	dbg_printf("FORWARD: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i;
+	uint32_t	n, lo, up, port;
+	uint8_t		portMask = srio_port_mask(lane_mode);
+	char		*end;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc >= 2 && strcmp(args[0], "del") == 0) {
+		if(strcmp(args[1], "all") == 0)
+			memset(srio_pf, 0, sizeof(srio_pf));
+		else {
+			n = strtoul(args[1], &end, 10);
+			if(n >= SRIO_PF_NUM) {
+				printf("### forwardFunc: bad entry %lu (0..%d)\n", n, SRIO_PF_NUM - 1);
+				return -1;
+			}
+			srio_pf[n].valid = 0;
+		}
+		SrioDevice_setForwarding();
+	}
+	else if(argc >= 4) {
+		n	 = strtoul(args[0], &end, 10);
+		lo	 = strtoul(args[1], &end, 16);
+		up	 = strtoul(args[2], &end, 16);
+		port = strtoul(args[3], &end, 10);
+		if(n >= SRIO_PF_NUM || lo > up || up > 0xFFFF) {
+			printf("### forwardFunc: bad entry %lu (0..%d) or ID range 0x%lX..0x%lX\n",
+				n, SRIO_PF_NUM - 1, lo, up);
+			return -1;
+		}
+		if(id_size == SRIO_ID_8BIT && up > 0xFF) {
+			printf("### forwardFunc: ID 0x%lX is too large for 8-bit ID size (see 'idsize')\n", up);
+			return -1;
+		}
+		if(port > 3 || ((portMask >> port) & 1) == 0) {
+			printf("### forwardFunc: port %lu is not formed by lane mode %d (ports mask 0x%X)\n",
+				port, lane_mode, portMask);
+			return -1;
+		}
+		if(main_deviceID >= lo && main_deviceID <= up)
+			printf("FORWARD: main ID 0x%X is in the range, its packets stay local\n", main_deviceID);
+		srio_pf[n].idLo	   = lo;
+		srio_pf[n].idUp	   = up;
+		srio_pf[n].outPort = port;
+		srio_pf[n].valid   = 1;
+		SrioDevice_setForwarding();
+	}
+	else if(argc > 0) {
+		printf("### forwardFunc: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	printf("FORWARD: packet forwarding table (lane mode %d)\n", lane_mode);
+	for(i=0; i<SRIO_PF_NUM; i++) {
+		if(srio_pf[i].valid == 0) continue;
+		printf("  %d: ID 0x%04X..0x%04X -> port %d%s\n", i, srio_pf[i].idLo, srio_pf[i].idUp,
+			srio_pf[i].outPort, ((portMask >> srio_pf[i].outPort) & 1) ? "" : " (port not formed, off)");
+	}
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// addrFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+extern void	SrioDevice_setAddrSize(int bits);
+
+int addrFunc(char *cmdStr)
+{
+	dbg_printf("ADDR: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			bits;
+	char		*end;
+
+	if(parse_args(cmdStr, args, MAX_ARGS) > 0) {
+		bits = strtoul(args[0], &end, 10);
+		if(bits != SRIO_ADDR_32 && bits != SRIO_ADDR_34 &&
+		   bits != SRIO_ADDR_50 && bits != SRIO_ADDR_66) {
+			printf("### addrFunc: bad address size '%s' (32, 34, 50 or 66)\n", args[0]);
+			return -1;
+		}
+		addr_bits = bits;
+		SrioDevice_setAddrSize(addr_bits);
+	}
+	printf("ADDR: %d-bit RapidIO addresses\n", addr_bits);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// loopbackFunc() /////////////////////////////////////
+///////////////////////////////////////////////////////////////
+extern int32_t	SrioDevice_setLoopback(int mode);
+
+int loopbackFunc(char *cmdStr)
+{
+	dbg_printf("LOOPBACK: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			mode;
+
+	if(parse_args(cmdStr, args, MAX_ARGS) > 0) {
+		if(strcmp(args[0], "on") == 0)				mode = SRIO_LOOPBACK_DIGITAL;
+		else if(strcmp(args[0], "serdes") == 0)		mode = SRIO_LOOPBACK_SERDES;
+		else if(strcmp(args[0], "off") == 0)		mode = SRIO_LOOPBACK_OFF;
+		else {
+			printf("### loopbackFunc: bad mode '%s' (on, serdes or off)\n", args[0]);
+			return -1;
+		}
+		if(SrioDevice_setLoopback(mode) < 0) {
+			printf("### loopbackFunc: SrioDevice_setLoopback(%d) error\n", mode);
+			return -1;
+		}
+	}
+	printf("LOOPBACK: %s\n", loopback_mode == SRIO_LOOPBACK_DIGITAL ? "digital" :
+		(loopback_mode == SRIO_LOOPBACK_SERDES ? "SERDES" : "off"));
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// txqFunc() //////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+extern uint8_t	srio_txq_port[16];
+extern uint8_t	srio_txq_prio[16];
+
+int txqFunc(char *cmdStr)
+{
+	dbg_printf("TXQ: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i;
+	uint32_t	q, prio, port;
+	char		*end;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc >= 2) {
+		q    = strtoul(args[0], &end, 10);
+		prio = strtoul(args[1], &end, 10);
+		port = (argc > 2) ? strtoul(args[2], &end, 10) : srio_txq_port[q & 0xF];
+		if(q > 15 || prio > 3 || port > 3) {
+			printf("### txqFunc: bad value (queue 0..15, priority 0..3, port 0..3)\n");
+			return -1;
+		}
+		srio_txq_prio[q] = prio;
+		srio_txq_port[q] = port;
+		CSL_SRIO_SetTxQueueSchedInfo(hSrio, q, port, prio);
+	}
+	else if(argc != 0) {
+		printf("### txqFunc: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	for(i=0; i<16; i++)
+		printf("TXQ %2d: port %d, priority %d\n", i, srio_txq_port[i], srio_txq_prio[i]);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// portsFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int portsFunc(char *cmdStr)
+{
+	dbg_printf("PORTS: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc;
+	uint32_t	port, val;
+	char		*end;
+	uint8_t		mask;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc == 2 && strcmp(args[0], "lanes") == 0) {
+		val = strtoul(args[1], &end, 10);
+		if(val > srio_lanes_form_one_4x_port || setSrioLanes(hSrio, val) < 0) {
+			printf("### portsFunc: bad lane mode %lu (0..4)\n", val);
+			return -1;
+		}
+		lane_mode = val;
+		srio_link_mask = srio_port_mask(lane_mode);
+		SrioDevice_setForwarding();		// re-arm the table, drop entries of the ports gone
+		waitAllSrioPortsOperational(hSrio, lane_mode);
+	}
+	else if(argc == 3 && strcmp(args[0], "dest") == 0) {
+		port = strtoul(args[1], &end, 10);
+		if(port > 3) {
+			printf("### portsFunc: bad port %lu\n", port);
+			return -1;
+		}
+		srio_port_dest[port] = (strcmp(args[2], "any") == 0) ? SRIO_PORT_DEST_ANY : strtoul(args[2], &end, 16);
+	}
+	else if(argc == 1 && strcmp(args[0], "clr") == 0) {
+		memset(srio_port_bytes, 0, sizeof(srio_port_bytes));
+	}
+	else if(argc != 0) {
+		printf("### portsFunc: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	mask = srio_port_mask(lane_mode);
+	printf("PORTS: lane mode %d, ports mask 0x%X\n", lane_mode, mask);
+	for(port=0; port<4; port++) {
+		if(((mask >> port) & 1) == 0) continue;
+		printf("PORT %lu: %-4s dest ", port, srio_link_ok(port) ? "OK" : "DOWN");
+		if(srio_port_dest[port] == SRIO_PORT_DEST_ANY)	printf("any ");
+		else											printf("%04lX", srio_port_dest[port]);
+		printf("  %lu bytes issued\n", srio_port_bytes[port]);
+	}
+	return 0;
+}
+
 int nreadFunc(char *cmdStr)
 {
 	dbg_printf("NREAD: %s\n", cmdStr);
 
-	uint32_t	destAdr;
-	uint8_t		destId;
+	uint16_t	destId;
+	SrioXfer	x;
+	int			cc;
+	char		adrStr[32];
 
 	char		str[128];
 	int 		len;
@@ -590,50 +1190,44 @@ int nreadFunc(char *cmdStr)
 	}
 	char *end;
 	destId = strtoul(str, &end, 16);
+	if(id_size == SRIO_ID_8BIT && destId > 0xFF) {
+		printf("### 16-bit ID 0x%04X in 8-bit ID mode (see 'idsize')\n", destId);
+		return -1;
+	}
 
 	pp = &cmdStr[len+1];
 	if( (len=parse_word(str,pp)) < 0) {
 		printf("### wrFunc: parse_word(,'%s') error\n", pp);
 		return -1;
 	}
-	destAdr = strtoul(str, &end, 16);
+	memset(&x, 0, sizeof(x));
+	if(srio_addr_parse(str, addr_bits, &x) < 0) {
+		printf("### NREAD: bad %d-bit address '%s' (see 'addr')\n", addr_bits, str);
+		return -1;
+	}
 
 	*((uint32_t *)SRC) =  0x01020304;
 
-	/* Make sure there is space in the Shadow registers to write*/
-	while (CSL_SRIO_IsLSUFull (hSrio, LSU) != 0);
-	// NWRITE Packet Type
-	CSL_SRIO_SetLSUReg0 (hSrio, LSU, 0); //no rapidio MSB
-	CSL_SRIO_SetLSUReg1 (hSrio, LSU, destAdr);
-	CSL_SRIO_SetLSUReg2 (hSrio, LSU, SRC);
-	CSL_SRIO_SetLSUReg3 (hSrio, LSU, 0x4, 0); //write 4 bytes, no doorbell
-	CSL_SRIO_SetLSUReg4 (hSrio, LSU,
-		destId,// destid
-		0,      // src id map = 0, using RIO_DEVICEID_REG0
-		0, 		//1,      // id size = 1 for 16bit device IDs
-		0,      // outport id = 0
-		0,      // priority = 0
-		0,      // xambs = 0
-		0,      // suppress good interrupt = 0 (don't care about interrupts)
-		0);     // interrupt request = 0
-	CSL_SRIO_SetLSUReg5 (hSrio, LSU,
-		4,//ttype,
-		2,//ftype,
-		hop_count,
-		0); 	// doorbell = 0
-
-	printf("NREAD (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, hop_count, destAdr, *((uint32_t *)SRC));
-
-	volatile static int timeout = 0;
-	while( *((int32_t *)SRC) == 0x01020304) {
-		timeout++;
-		if(timeout>10000000) {
-			printf("### Timeout Error\n");
-			return -1;
-		}
+	x.destId	= destId;
+	x.idSize	= id_size;
+	x.ftype		= SRIO_FTYPE_NREAD;
+	x.ttype		= SRIO_TTYPE_NREAD;
+	x.hopCount	= hop_count;
+	x.localAdr	= SRC;
+	x.size		= 4;
+	srio_xfer_class(&x, xfer_class);
+	x.outPort	= srio_port_next(destId);
+	srio_route_apply(&x);
+
+	if(async_mode)
+		return (srio_async_submit("NREAD", &x, xfer_class, 0, SRIO_ASYNC_WORD) < 0) ? -1 : 0;
+
+	if( (cc=srio_xfer(cmd_lsu(), &x)) != SRIO_CC_OK) {
+		printf("### NREAD Error: %s\n", srio_cc_str(cc));
+		return -1;
 	}
 
-	printf("NREAD (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, hop_count, destAdr, *((uint32_t *)SRC));
+	printf("NREAD (ID=0x%02lX, HOP=%d):  %s = 0x%08lX\n", destId, x.hopCount, srio_addr_str(&x, adrStr), *((uint32_t *)SRC));
 
 	return 0;
 }
@@ -645,8 +1239,10 @@ int nwriteFunc(char *cmdStr)
 {
 	dbg_printf("NWRITE: %s\n", cmdStr);
 
-	uint32_t	destAdr;
-	uint8_t		destId;
+	uint16_t	destId;
+	SrioXfer	x;
+	int			cc;
+	char		adrStr[32];
 	uint32_t	val;
 
 	char		str[128];
@@ -659,6 +1255,10 @@ int nwriteFunc(char *cmdStr)
 	}
 	char *end;
 	destId = strtoul(str, &end, 16);
+	if(id_size == SRIO_ID_8BIT && destId > 0xFF) {
+		printf("### 16-bit ID 0x%04X in 8-bit ID mode (see 'idsize')\n", destId);
+		return -1;
+	}
 
 	int 		len2;
 	pp = &cmdStr[len1+1];
@@ -666,7 +1266,11 @@ int nwriteFunc(char *cmdStr)
 		printf("### nwriteFunc: parse_word(,'%s') error\n", pp);
 		return -1;
 	}
-	destAdr = strtoul(str, &end, 16);
+	memset(&x, 0, sizeof(x));
+	if(srio_addr_parse(str, addr_bits, &x) < 0) {
+		printf("### NWRITE: bad %d-bit address '%s' (see 'addr')\n", addr_bits, str);
+		return -1;
+	}
 
 	int len3;
 	pp = &cmdStr[len1+len2+2];
@@ -677,29 +1281,26 @@ int nwriteFunc(char *cmdStr)
 	val = strtoul(str, &end, 16);
 	*((uint32_t *)SRC) =  val;
 
-	/* Make sure there is space in the Shadow registers to write*/
-	while (CSL_SRIO_IsLSUFull (hSrio, LSU) != 0);
-	// NWRITE Packet Type
-	CSL_SRIO_SetLSUReg0 (hSrio, LSU, 0); //no rapidio MSB
-	CSL_SRIO_SetLSUReg1 (hSrio, LSU, destAdr);
-	CSL_SRIO_SetLSUReg2 (hSrio, LSU, SRC);
-	CSL_SRIO_SetLSUReg3 (hSrio, LSU, 0x4, 0); //write 4 bytes, no doorbell
-	CSL_SRIO_SetLSUReg4 (hSrio, LSU,
-		destId,// destid
-		0,      // src id map = 0, using RIO_DEVICEID_REG0
-		0, 		//1,      // id size = 1 for 16bit device IDs
-		0,      // outport id = 0
-		0,      // priority = 0
-		0,      // xambs = 0
-		0,      // suppress good interrupt = 0 (don't care about interrupts)
-		0);     // interrupt request = 0
-	CSL_SRIO_SetLSUReg5 (hSrio, LSU,
-		4,//ttype,
-		5,//ftype,
-		hop_count,
-		0); 	// doorbell = 0
-
-	printf("NWRITE (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, hop_count, destAdr, *((uint32_t *)SRC));
+	x.destId	= destId;
+	x.idSize	= id_size;
+	x.ftype		= SRIO_FTYPE_NWRITE;
+	x.ttype		= SRIO_TTYPE_NWRITE;
+	x.hopCount	= hop_count;
+	x.localAdr	= SRC;
+	x.size		= 4;
+	srio_xfer_class(&x, xfer_class);
+	x.outPort	= srio_port_next(destId);
+	srio_route_apply(&x);
+
+	if(async_mode)
+		return (srio_async_submit("NWRITE", &x, xfer_class, 0, SRIO_ASYNC_WORD) < 0) ? -1 : 0;
+
+	if( (cc=srio_xfer(cmd_lsu(), &x)) != SRIO_CC_OK) {
+		printf("### NWRITE Error: %s\n", srio_cc_str(cc));
+		return -1;
+	}
+
+	printf("NWRITE (ID=0x%02lX, HOP=%d):  %s = 0x%08lX\n", destId, x.hopCount, srio_addr_str(&x, adrStr), *((uint32_t *)SRC));
 
 	return 0;
 }
@@ -712,7 +1313,7 @@ int mreadFunc(char *cmdStr)
 	dbg_printf("MREAD: %s\n", cmdStr);
 
 	uint32_t	destAdr;
-	uint8_t		destId;
+	uint16_t	destId;
 
 	char		str[128];
 	int 		len;
@@ -724,6 +1325,10 @@ int mreadFunc(char *cmdStr)
 	}
 	char *end;
 	destId = strtoul(str, &end, 16);
+	if(id_size == SRIO_ID_8BIT && destId > 0xFF) {
+		printf("### 16-bit ID 0x%04X in 8-bit ID mode (see 'idsize')\n", destId);
+		return -1;
+	}
 
 	pp = &cmdStr[len+1];
 	if( (len=parse_word(str,pp)) < 0) {
@@ -734,40 +1339,30 @@ int mreadFunc(char *cmdStr)
 
 	*((uint32_t *)SRC) =  0x01020304;
 
-	/* Make sure there is space in the Shadow registers to write*/
-	while (CSL_SRIO_IsLSUFull (hSrio, LSU) != 0);
-	// NWRITE Packet Type
-	CSL_SRIO_SetLSUReg0 (hSrio, LSU, 0); //no rapidio MSB
-	CSL_SRIO_SetLSUReg1 (hSrio, LSU, destAdr);
-	CSL_SRIO_SetLSUReg2 (hSrio, LSU, SRC);
-	CSL_SRIO_SetLSUReg3 (hSrio, LSU, 0x4, 0); //write 4 bytes, no doorbell
-	CSL_SRIO_SetLSUReg4 (hSrio, LSU,
-		destId,// destid
-		0,      // src id map = 0, using RIO_DEVICEID_REG0
-		0, 		//1,      // id size = 1 for 16bit device IDs
-		0,      // outport id = 0
-		0,      // priority = 0
-		0,      // xambs = 0
-		0,      // suppress good interrupt = 0 (don't care about interrupts)
-		0);     // interrupt request = 0
-	CSL_SRIO_SetLSUReg5 (hSrio, LSU,
-		0,//ttype,
-		8,//ftype,
-		hop_count,
-		0); 	// doorbell = 0
-
-	printf("NREAD (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, hop_count, destAdr, *((uint32_t *)SRC));
-
-	volatile static int timeout = 0;
-	while( *((int32_t *)SRC) == 0x01020304) {
-		timeout++;
-		if(timeout>10000000) {
-			printf("### Timeout Error\n");
-			return -1;
-		}
+	SrioXfer	x;
+	int			cc;
+	memset(&x, 0, sizeof(x));
+	x.destId	= destId;
+	x.idSize	= id_size;
+	x.ftype		= SRIO_FTYPE_MAINT;
+	x.ttype		= SRIO_TTYPE_MAINT_RD;
+	x.hopCount	= hop_count;
+	x.remoteAdr	= destAdr;
+	x.localAdr	= SRC;
+	x.size		= 4;
+	srio_xfer_class(&x, xfer_class);
+	x.outPort	= srio_port_next(destId);
+	srio_route_apply(&x);
+
+	if(async_mode)
+		return (srio_async_submit("MREAD", &x, xfer_class, 0, SRIO_ASYNC_WORD) < 0) ? -1 : 0;
+
+	if( (cc=srio_xfer(cmd_lsu(), &x)) != SRIO_CC_OK) {
+		printf("### MREAD Error: %s\n", srio_cc_str(cc));
+		return -1;
 	}
 
-	printf("MREAD (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, hop_count, destAdr, *((uint32_t *)SRC));
+	printf("MREAD (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, x.hopCount, destAdr, *((uint32_t *)SRC));
 
 	return 0;
 }
@@ -780,7 +1375,7 @@ int mwriteFunc(char *cmdStr)
 	dbg_printf("MWRITE: %s\n", cmdStr);
 
 	uint32_t	destAdr;
-	uint8_t		destId;
+	uint16_t	destId;
 	uint32_t	val;
 
 	char		str[128];
@@ -793,6 +1388,10 @@ int mwriteFunc(char *cmdStr)
 	}
 	char *end;
 	destId = strtoul(str, &end, 16);
+	if(id_size == SRIO_ID_8BIT && destId > 0xFF) {
+		printf("### 16-bit ID 0x%04X in 8-bit ID mode (see 'idsize')\n", destId);
+		return -1;
+	}
 
 	int 		len2;
 	pp = &cmdStr[len1+1];
@@ -811,29 +1410,30 @@ int mwriteFunc(char *cmdStr)
 	val = strtoul(str, &end, 16);
 	*((uint32_t *)SRC) =  val;
 
-	/* Make sure there is space in the Shadow registers to write*/
-	while (CSL_SRIO_IsLSUFull (hSrio, LSU) != 0);
-	// NWRITE Packet Type
-	CSL_SRIO_SetLSUReg0 (hSrio, LSU, 0); //no rapidio MSB
-	CSL_SRIO_SetLSUReg1 (hSrio, LSU, destAdr);
-	CSL_SRIO_SetLSUReg2 (hSrio, LSU, SRC);
-	CSL_SRIO_SetLSUReg3 (hSrio, LSU, 0x4, 0); //write 4 bytes, no doorbell
-	CSL_SRIO_SetLSUReg4 (hSrio, LSU,
-		destId,// destid
-		0,      // src id map = 0, using RIO_DEVICEID_REG0
-		0, 		//1,      // id size = 1 for 16bit device IDs
-		0,      // outport id = 0
-		0,      // priority = 0
-		0,      // xambs = 0
-		0,      // suppress good interrupt = 0 (don't care about interrupts)
-		0);     // interrupt request = 0
-	CSL_SRIO_SetLSUReg5 (hSrio, LSU,
-		1,//ttype,
-		8,//ftype,
-		hop_count,
-		0); 	// doorbell = 0
-
-	printf("NWRITE (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, hop_count, destAdr, *((uint32_t *)SRC));
+	SrioXfer	x;
+	int			cc;
+	memset(&x, 0, sizeof(x));
+	x.destId	= destId;
+	x.idSize	= id_size;
+	x.ftype		= SRIO_FTYPE_MAINT;
+	x.ttype		= SRIO_TTYPE_MAINT_WR;
+	x.hopCount	= hop_count;
+	x.remoteAdr	= destAdr;
+	x.localAdr	= SRC;
+	x.size		= 4;
+	srio_xfer_class(&x, xfer_class);
+	x.outPort	= srio_port_next(destId);
+	srio_route_apply(&x);
+
+	if(async_mode)
+		return (srio_async_submit("MWRITE", &x, xfer_class, 0, SRIO_ASYNC_WORD) < 0) ? -1 : 0;
+
+	if( (cc=srio_xfer(cmd_lsu(), &x)) != SRIO_CC_OK) {
+		printf("### MWRITE Error: %s\n", srio_cc_str(cc));
+		return -1;
+	}
+
+	printf("MWRITE (ID=0x%02lX, HOP=%d):  0x%08lX = 0x%08lX\n", destId, x.hopCount, destAdr, *((uint32_t *)SRC));
 
 	return 0;
 }
@@ -852,15 +1452,62 @@ int	print_cmd_list()
 	printf("write <AdrHex> <ValHex>             Write memory word (alias - wr or w)\n");
 	printf("fill <AdrHex> <SizeDec> <ValHex>    Fill memry\n");
 	printf("dbg                                 Set/clr debug print message (alias - d)\n");
+	printf("console [async|sync|clr]            Buffered (async) or direct console output\n");
 	printf("help                                View this help message (alias - h or ?)\n");
 
 	printf("=========== SRIO Command ===========================================================\n");
 	printf("nread  <IdHex> <AdrHex>             Read memory word from SRIO ID (alias - nr)\n");
+	printf("       <AdrHex> - up to 34/50/66-bit RapidIO address (see 'addr')\n");
 	printf("nwrite <IdHex> <AdrHex> <ValHex>    Write memory to SRIO ID (alias - nw)\n");
 	printf("mread  <IdHex> <AdrHex>             Maint read memory word from SRIO ID (alias - nr)\n");
 	printf("mwrite <IdHex> <AdrHex> <ValHex>    Maint write memory to SRIO ID (alias - nw)\n");
-	printf("lsu <NumDec>                        Set LSU number (default 0)\n");
-	printf("hop <NumDec>                        Set hop_count (default 0)\n");
+	printf("lsu <NumDec>|auto                   Set LSU number (default auto - by class)\n");
+	printf("hop <NumDec>                        Set hop_count of IDs without route (default 0)\n");
+	printf("devid [add <IdHex>|del <IdHex>|all]  View/add/delete secondary device IDs\n");
+	printf("forward [<N> <IdLoHex> <IdUpHex> <Port>] | del <N>|all  Packet forwarding table\n");
+	printf("addr [32|34|50|66]                  Set/view RapidIO address size of nread/nwrite\n");
+	printf("idsize [8|16]                       Set/view device ID size of SRIO commands\n");
+	printf("class [ctrl|bulk]                   Set priority class of SRIO commands\n");
+	printf("prio [<Class> <Prio> <Crf> <LsuMaskHex>]  Set/view class priority, CRF and LSUs\n");
+	printf("retry [<TimeoutUs> [Retries] [BackoffUs] [MaxUs]] | clr  Set/view timeout and retry policy\n");
+	printf("txq [<QueueDec> <Prio> [<Port>]]    Set/view TX queue priority map\n");
+	printf("loopback [on|serdes|off]            Set/view digital or SERDES loopback of ports\n");
+	printf("selftest [Size] [Count] [Src Dst Chk]  Loopback throughput/latency test (own ID)\n");
+	printf("link [auto on|off] [mask <Hex>]     Link supervisor status / mode / supervised ports\n");
+	printf("link recover <PortDec>              Flush LSUs, resync ackIDs and reset port\n");
+	printf("events [clr]                        Print and drain port-write/error event queue\n");
+	printf("ports [lanes <Mode>] [dest <Port> <IdHex>|any] [clr]  Lane mode and port routes\n");
+	printf("bwrite <IdHex> <AdrHex> <LocAdrHex> <SizeDec> [ChunkDec]  NWRITE block striped over ports\n");
+	printf("bread  <IdHex> <AdrHex> <LocAdrHex> <SizeDec> [ChunkDec]  NREAD block striped over ports\n");
+	printf("bcast  <IdList> <AdrHex> <LocAdrHex> <SizeDec> [ChunkDec]  NWRITE block to IDs (e.g. 1,4-7)\n");
+	printf("async [on|off]                      Async mode: SRIO commands return a ticket\n");
+	printf("wait <Ticket>|all                   Wait for ticket(s) and print result\n");
+	printf("poll                                Show tickets in progress, print done ones\n");
+	printf("snap <Slot> [remote <IdHex> [Hop]]  Capture SRIO/SERDES registers (or remote config space)\n");
+	printf("snap [show <Slot>]                  List snapshots / print named registers\n");
+	printf("snapdiff <SlotA> <SlotB>            Print registers changed between snapshots\n");
+	printf("sg add <IdHex> <RemAdrHex> <LocAdrHex> <LenDec> [w|wr|r]  Add scatter/gather descriptor\n");
+	printf("sg [clr] | sg run [Count]           View/clear/execute descriptor chain\n");
+	printf("prbs <IdHex> [SizeDec] [Sec] [prbs|cnt] [RemAdrHex]  Pattern soak test with data check\n");
+	printf("ring tx|rx <IdHex> [RemBaseHex] [LocBaseHex]  Open ring channel to peer\n");
+	printf("ring send [CountDec] [BatchDec] | recv [Sec] | db on|off | close  Ring channel\n");
+	printf("remote <IdHex> <Command>            Run monitor command on other board\n");
+	printf("remote serve [Sec]                  Serve remote commands (default 10 s)\n");
+	printf("route [del <IdHex>|all]             View/delete per-destination routes\n");
+	printf("route set <IdHex> [hop N] [port N] [idsize 8|16] [prio N] [write nw|nwr|sw]  Set route\n");
+	printf("route disc <FirstIdHex> <LastIdHex> [MaxHopDec]  Discover hop count and port of IDs\n");
+	printf("serdes [set <Lane|all> <RxHex> <TxHex>]  View/set SERDES lane configuration\n");
+	printf("serdes tune <Port> <IdHex> [MsDec]  Sweep equalizer/swing/de-emphasis, apply the best\n");
+	printf("serdes save <FileName>              Save tuned lanes as 'serdes set' commands\n");
+	printf("tsync [<IdHex> [SamplesDec]] | clr  Sync/view peer TSC offsets\n");
+	printf("tsync lat <IdHex> [CountDec]        One-way latency of both directions\n");
+	printf("tsync serve [Sec]                   Answer time sync requests (default 10 s)\n");
+	printf("loadgen <IdList> [mix=W/R/M] [size=Min-Max] [rate=N] [win=N] [time=Sec] [int=Sec] [adr=Hex]\n");
+	printf("                                    Mixed NWRITE/NREAD/MAINT load, report every interval\n");
+	printf("trace [on|off|clr]                  SRIO trace status / enable / clear\n");
+	printf("trace dump [NumDec]                 Print last trace entries (default 32)\n");
+	printf("trace copy <AdrHex>                 Copy binary trace to memory\n");
+	printf("trace save <FileName>               Save binary trace to host file\n");
 
 	printf("============================================================================================\n");
 
@@ -890,6 +1537,36 @@ static CmdEntry   cmdEntries[] =
 	{ "mw",			mwriteFunc },	// SRIO Maint Write Packet
 	{ "hop",		hopFunc },		// SRIO set hop_count value
 	{ "lsu",		lsuFunc },		// SRIO set LSU number
+	{ "devid",		devidFunc },	// secondary device IDs
+	{ "forward",	forwardFunc },	// hardware packet forwarding table
+	{ "addr",		addrFunc },		// SRIO RapidIO address size
+	{ "idsize",		idsizeFunc },	// SRIO device ID size
+	{ "class",		classFunc },	// SRIO set priority class
+	{ "prio",		prioFunc },		// SRIO class priority configuration
+	{ "retry",		retryFunc },	// transaction timeout and retry policy
+	{ "txq",		txqFunc },		// SRIO TX queue priority map
+	{ "loopback",	loopbackFunc },	// SRIO ports loopback mode
+	{ "selftest",	selftestFunc },	// SRIO loopback benchmark
+	{ "ports",		portsFunc },	// lane mode and port routes
+	{ "bwrite",		bwriteFunc },	// striped block NWRITE
+	{ "bread",		breadFunc },	// striped block NREAD
+	{ "bcast",		bcastFunc },	// block NWRITE to several IDs
+	{ "async",		asyncFunc },	// asynchronous (ticketed) mode
+	{ "wait",		waitFunc },		// wait for ticket
+	{ "poll",		pollFunc },		// tickets status
+	{ "snap",		snapFunc },		// register snapshot
+	{ "snapdiff",	snapdiffFunc },	// snapshot diff
+	{ "sg",			sgFunc },		// scatter/gather chain
+	{ "prbs",		prbsFunc },		// pattern soak test
+	{ "ring",		ringFunc },		// SPSC ring channel
+	{ "remote",		remoteFunc },	// remote command (RPC)
+	{ "route",		routeFunc },	// per-destination routes
+	{ "serdes",		serdesFunc },	// SERDES tuning
+	{ "tsync",		tsyncFunc },	// TSC time sync
+	{ "loadgen",	loadgenFunc },	// mixed traffic load generator
+	{ "link",		linkFunc },		// link supervisor
+	{ "events",		eventsFunc },	// port-write and error events
+	{ "trace",		traceFunc },	// SRIO transaction trace
 	{ "quit",		quitFunc },		// quit app
 	{ "q",			quitFunc },		// quit app
 	{ "read",		rdFunc },		// direct read memory
@@ -900,6 +1577,7 @@ static CmdEntry   cmdEntries[] =
 	{ "dump",		dumpFunc },		// read dump memory
 	{ "fill",		fillFunc },		// fill memory
 	{ "dbg",		dbgFunc },		// set/clr debug mode
+	{ "console",	conFunc },		// console output mode
 	{ "d",			dbgFunc },		// set/clr debug mode
 	{ "help",		helpFunc },		// print help verbose
 	{ "h",			helpFunc },		// print help verbose
@@ -910,6 +1588,83 @@ static CmdEntry   cmdEntries[] =
 
 char	cmdbuf[256];
 
+/*********************** service_poll ********************
+* Background work done between the commands
+****************************************************/
+static void	service_poll(void)
+{
+	srio_trace_poll();
+	srio_event_poll();
+	srio_link_poll();
+	srio_async_poll();
+	srio_ring_poll();
+	srio_rpc_poll();
+	srio_tsync_poll();
+	con_drain(CON_DRAIN_CHUNK);
+}
+
+/*********************** idle_run ********************
+* Background work of the long running commands and LSU waits: events,
+* link supervisor and (drain != 0) console output, at most every
+* CMD_IDLE_US. The BIOS is not started, so this is the periodic context
+* while a command runs.
+****************************************************/
+static void	idle_run(int drain)
+{
+	static uint64_t	tNext;
+	static int		busy;
+	uint64_t		now = CSL_tscRead();
+
+	if(busy || now < tNext) return;
+	busy  = 1;
+	tNext = now + (uint64_t)CMD_IDLE_US * CPU_FREQ_MHZ;
+	srio_event_poll();
+	srio_link_poll();
+	if(drain) con_drain(CON_DRAIN_CHUNK);
+	busy  = 0;
+}
+
+/*********************** cmd_idle ********************
+* Background work of a long running command loop
+****************************************************/
+void	cmd_idle(void)
+{
+	idle_run(1);
+}
+
+/*********************** cmd_idle_wait ********************
+* Background work of an LSU wait: no console output, the host I/O would
+* hold up the transfer
+****************************************************/
+void	cmd_idle_wait(void)
+{
+	idle_run(0);
+}
+
+/*********************** cmd_exec ********************
+* Parse the command line and run the command of the table
+****************************************************/
+int	cmd_exec(char *cmdbuf)
+{
+	// parse command
+	char cmd[32];
+	int ret = 0;
+	if( (ret=parse_word(cmd,cmdbuf)) < 0) {
+		printf("Error command string");
+		return -1;
+	}
+	dbg_printf("command: '%s' (length = %d)\n", cmd, ret);
+
+	int ii;
+    for( ii=0; ii<sizeof(cmdEntries)/sizeof(cmdEntries[0]); ii++ )
+    {
+        if( strcmp(cmdEntries[ii].cmd,cmd) == 0 )
+            return cmdEntries[ii].func( cmdbuf[ret] ? &cmdbuf[ret+1] : &cmdbuf[ret] );
+    }
+   	printf("### BAD Command - %s\n", cmd);
+	return -1;
+}
+
 /*
  * main.c
  */
@@ -928,6 +1683,9 @@ int main(int argc, char *argv[])
 	printf("======== (C) PapaKarlo Software, Sep. 2019) ================= \n");
 	printf("============================================================= \n");
 
+	/* Start TSC for time stamps */
+	CSL_tscEnable();
+
 	for(i=0;i<argc;i++)
 	{
 		if(argv[i][0] == '-')
@@ -935,12 +1693,33 @@ int main(int argc, char *argv[])
 			switch(argv[i][1]) {
 			case 'v':
 			case 'V':	verbose_flag = 1; break;
+			case 'r':
+			case 'R':	rpc_serve = 1; break;
+			case 's':
+			case 'S':	{
+				/* secondary IDs: -s<Id>[,<Id>...] */
+				char *p = &argv[i][2], *end;
+				while(*p && srio_devid_num < SRIO_DEVID_MAX) {
+					srio_devid[srio_devid_num++] = strtoul(p, &end, 16);
+					if(end == p) { srio_devid_num--; break; }
+					p = (*end == ',') ? end + 1 : end;
+				}
+				break;
+				}
 			case 'b':
 			case 'B':	board_id = atol(&argv[i][2]); break;
+			case 'p':
+			case 'P':	lane_mode = atol(&argv[i][2]); break;
+			case 'L':
+				if(argv[i][2] == 's' || argv[i][2] == 'S')	loopback_mode = SRIO_LOOPBACK_SERDES;
+				else										loopback_mode = SRIO_LOOPBACK_DIGITAL;
+				break;
 			case 'd':
 			case 'D':	{
 				char *end;
 				main_deviceID = strtoul(&argv[i][2], &end, 16);
+				/* more than 2 hex digits - 16-bit device ID */
+				id_size = ((end - &argv[i][2]) > 2) ? SRIO_ID_16BIT : SRIO_ID_8BIT;
 				break;
 				}
 			case 'h':
@@ -950,7 +1729,8 @@ int main(int argc, char *argv[])
 		}
 	}
 
-	printf ("Board ID = %d, main Device ID = 0x%X\n", board_id, main_deviceID);
+	printf ("Board ID = %d, main Device ID = 0x%0*X (%s-bit)\n", board_id,
+		id_size ? 4 : 2, main_deviceID, id_size ? "16" : "8");
 
 	if(verbose_flag) printf ("SRIO APP START\n");
 
@@ -967,6 +1747,14 @@ int main(int argc, char *argv[])
 	if (SrioDevice_init(speed) < 0)
 		return -2;
 
+	/* Supervise the ports formed by the lane mode */
+	srio_link_mask = srio_port_mask(lane_mode);
+
+	/* Port-write and error event capture */
+	srio_event_init();
+	srio_rpc_init();
+	srio_tsync_init();
+
 //	setSrioLanes (hSrio, srio_lanes_form_one_4x_port);
 
 	/* SRIO Driver is operational at this time. */
@@ -983,34 +1771,17 @@ int main(int argc, char *argv[])
     CSL_SRIO_GetDeviceInfo(hSrio, &deviceId, &deviceVendorId, &deviceRev);
     if(verbose_flag) printf("DevID = 0x%X, DevVendorID = 0x%X, DevRev = 0x%X\n", deviceId, deviceVendorId, deviceRev);
 
+	con_async = 1;
 	while(1)	// Command cycle
 	{
+		service_poll();
+		if(rpc_serve) continue;			// -r: no console, remote commands only
 		if(dbg_flag==0) 		printf("$>");					//
 		else if(dbg_flag==1) 	printf("DBG$>");					//
+		con_drain(0);
 		gets(cmdbuf);					// get command string
 		dbg_printf("%s\n",cmdbuf);			// print Command String
-		// parse command
-		char cmd[32];
-		int ret = 0;
-		if( (ret=parse_word(cmd,cmdbuf)) < 0) {
-			printf("Error command string");
-			continue;
-		}
-		dbg_printf("command: '%s' (length = %d)\n", cmd, ret);
-
-		int ii;
-	    for( ii=0; ii<sizeof(cmdEntries)/sizeof(cmdEntries[0]); ii++ )
-	    {
-	        if( strcmp(cmdEntries[ii].cmd,cmd) == 0 )
-	        {
-	            cmdEntries[ii].func( &cmdbuf[ret+1] );
-	            break;
-	        }
-	    }
-	    if(ii==sizeof(cmdEntries)/sizeof(cmdEntries[0])) {
-	    	printf("### BAD Command - %s\n", cmd);
-	    }
-
+		cmd_exec(cmdbuf);
 	}
 
 
@@ -0,0 +1,283 @@
+/*
+ *  srio_async.c
+ *
+ *  Asynchronous (ticketed) SRIO commands of the SRIO Command Monitor.
+ *
+ *  In async mode the SRIO commands do not wait for the completion: the
+ *  transfer is placed in a ticket and the ticket number is printed.
+ *  The tickets are progressed by the command loop poll and by 'wait'
+ *  without blocking on the LSUs, so many slow remote operations overlap.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_link.h"
+#include "srio_async.h"
+
+int					async_mode = 0;
+
+static SrioTicket	tickets[SRIO_ASYNC_TICKETS];
+static uint32_t		ticket_next = 1;
+
+/**
+ *  @b Description
+ *  @n
+ *      Start the asynchronous transfer.
+ *
+ *  @param[in]  name
+ *      Command name for the reports.
+ *  @param[in]  x
+ *      Transfer; with SRIO_ASYNC_WORD the word at x->localAdr is copied
+ *      into the ticket (NWRITE data) and NREAD data is returned there.
+ *  @param[in]  cls
+ *      Priority class.
+ *  @param[in]  chunk
+ *      Bytes per LSU request (0 - SRIO_STRIPE_CHUNK).
+ *  @param[in]  flags
+ *      SRIO_ASYNC_xxx.
+ *
+ *  @retval
+ *      Success - ticket number
+ *  @retval
+ *      Error   - <0 (no free ticket)
+ */
+int	srio_async_submit(const char *name, const SrioXfer *x, int cls, uint32_t chunk, int flags)
+{
+	SrioTicket	*t;
+	int			i;
+
+	if(x->remoteAdr + x->size - 1 < x->remoteAdr) {	// chunks don't carry into remoteAdrHi/xambs
+		printf("### %s: bad size %lu (block can't cross 4 GB boundary)\n", name, x->size);
+		return -1;
+	}
+	for(i=0; i<SRIO_ASYNC_TICKETS; i++)
+		if(tickets[i].state == TICKET_FREE) break;
+	if(i == SRIO_ASYNC_TICKETS) {
+		printf("### %s: no free ticket (%d in use, see 'wait')\n", name, SRIO_ASYNC_TICKETS);
+		return -1;
+	}
+	t = &tickets[i];
+
+	memset(t, 0, sizeof(*t));
+	t->id    = ticket_next++;
+	t->flags = flags;
+	t->cls   = cls;
+	strncpy(t->name, name, sizeof(t->name)-1);
+	t->x     = *x;
+	t->chunk = (chunk == 0 || chunk > SRIO_LSU_MAX_BYTES) ? SRIO_STRIPE_CHUNK : chunk;
+	t->cc    = SRIO_CC_OK;
+	if(flags & SRIO_ASYNC_WORD) {
+		t->data       = *((volatile uint32_t *)x->localAdr);
+		t->x.localAdr = srio_global_adr((uint32_t)&t->data);
+		t->x.size     = 4;
+	}
+	t->tscStart    = CSL_tscRead();
+	t->tscProgress = t->tscStart;
+	t->state       = TICKET_ACTIVE;
+
+	srio_async_poll();
+	printf("TICKET %lu: %s started\n", t->id, t->name);
+	return t->id;
+}
+
+/*********************** ticket_step ********************
+* Collect completed requests and issue new ones without waiting
+****************************************************/
+static void	ticket_step(SrioTicket *t)
+{
+	SrioOp		*op;
+	SrioXfer	part;
+	uint8_t		cc, lsu;
+	uint64_t	now = CSL_tscRead();
+
+	/* Completions in issue order */
+	while(t->num) {
+		op = &t->ops[t->first];
+		if(srio_xfer_done(op, &cc) == 0) {
+			if(srio_link_ok(op->xfer.outPort) == 0) {
+				srio_lsu_flush(op->xfer.outPort);
+				srio_xfer_abort(op);
+				cc = SRIO_CC_LINK_DOWN;
+			}
+			else if(now - t->tscProgress > (uint64_t)SRIO_ASYNC_TIMEOUT_US * CPU_FREQ_MHZ) {
+				srio_xfer_abort(op);		// no late DMA into the ticket buffer
+				cc = SRIO_CC_SW_TIMEOUT;
+			}
+			else
+				break;
+		}
+		if(cc != SRIO_CC_OK && t->cc == SRIO_CC_OK) t->cc = cc;
+		t->first = (t->first + 1) % SRIO_STRIPE_WINDOW;
+		t->num--;
+		t->tscProgress = now;
+	}
+
+	/* New requests while there are free LSU shadow registers */
+	while(t->cc == SRIO_CC_OK && t->issued < t->x.size && t->num < SRIO_STRIPE_WINDOW) {
+		lsu = srio_lsu_select(t->cls);
+		if(CSL_SRIO_IsLSUFull (hSrio, lsu) != 0) break;
+
+		part = t->x;
+		if(t->flags & SRIO_ASYNC_STRIPE) part.outPort = srio_port_next(t->x.destId);
+		part.remoteAdr = t->x.remoteAdr + t->issued;
+		part.localAdr  = t->x.localAdr + t->issued;
+		part.size      = (t->x.size - t->issued < t->chunk) ? t->x.size - t->issued : t->chunk;
+
+		cc = srio_xfer_issue(lsu, &part, &t->ops[(t->first + t->num) % SRIO_STRIPE_WINDOW]);
+		if(cc != SRIO_CC_OK) { t->cc = cc; break; }
+		t->num++;
+		t->issued += part.size;
+		t->tscProgress = now;
+	}
+
+	if(t->num == 0 && (t->issued >= t->x.size || t->cc != SRIO_CC_OK)) {
+		t->tscEnd = CSL_tscRead();
+		t->state  = TICKET_DONE;
+	}
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Progress all active tickets. Called from the command loop poll.
+ */
+void	srio_async_poll(void)
+{
+	int		i;
+
+	for(i=0; i<SRIO_ASYNC_TICKETS; i++)
+		if(tickets[i].state == TICKET_ACTIVE)
+			ticket_step(&tickets[i]);
+}
+
+/*********************** ticket_report ********************
+* Print the result of the done ticket and release it
+****************************************************/
+static void	ticket_report(SrioTicket *t)
+{
+	uint32_t	us = (uint32_t)((t->tscEnd - t->tscStart) / CPU_FREQ_MHZ);
+
+	if(t->cc != SRIO_CC_OK)
+		printf("### TICKET %lu: %s Error: %s (%lu us)\n", t->id, t->name, srio_cc_str(t->cc), us);
+	else if(t->flags & SRIO_ASYNC_WORD)
+		printf("TICKET %lu: %s (ID=0x%02X) 0x%08lX = 0x%08lX (%lu us)\n", t->id, t->name,
+			t->x.destId, t->x.remoteAdr, t->data, us);
+	else
+		printf("TICKET %lu: %s (ID=0x%02X) 0x%08lX, %lu bytes in %lu us, %lu MB/s\n", t->id, t->name,
+			t->x.destId, t->x.remoteAdr, t->x.size, us, us ? t->x.size / us : 0);
+	t->state = TICKET_FREE;
+}
+
+/*********************** ticket_find ********************
+****************************************************/
+static SrioTicket	*ticket_find(uint32_t id)
+{
+	int		i;
+
+	for(i=0; i<SRIO_ASYNC_TICKETS; i++)
+		if(tickets[i].state != TICKET_FREE && tickets[i].id == id)
+			return &tickets[i];
+	return NULL;
+}
+
+///////////////////////////////////////////////////////////////
+////////// asyncFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int asyncFunc(char *cmdStr)
+{
+	dbg_printf("ASYNC: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+
+	if(parse_args(cmdStr, args, MAX_ARGS) > 0) {
+		if(strcmp(args[0], "on") == 0)			async_mode = 1;
+		else if(strcmp(args[0], "off") == 0)	async_mode = 0;
+		else {
+			printf("### async: bad mode '%s' (on or off)\n", args[0]);
+			return -1;
+		}
+	}
+	printf("ASYNC: %s\n", async_mode ? "on" : "off");
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// waitFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int waitFunc(char *cmdStr)
+{
+	dbg_printf("WAIT: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	char		*end;
+	SrioTicket	*t;
+	int			i, busy, ret = 0;
+
+	if(parse_args(cmdStr, args, MAX_ARGS) < 1) {
+		printf("### wait: ticket number or 'all' expected\n");
+		return -1;
+	}
+
+	if(strcmp(args[0], "all") == 0) {
+		do {
+			srio_async_poll();
+			cmd_idle_wait();
+			for(i=0, busy=0; i<SRIO_ASYNC_TICKETS; i++)
+				if(tickets[i].state == TICKET_ACTIVE) busy++;
+		} while(busy);
+		for(i=0; i<SRIO_ASYNC_TICKETS; i++) {
+			if(tickets[i].state != TICKET_DONE) continue;
+			if(tickets[i].cc != SRIO_CC_OK) ret = -1;
+			ticket_report(&tickets[i]);
+		}
+		return ret;
+	}
+
+	t = ticket_find(strtoul(args[0], &end, 10));
+	if(t == NULL) {
+		printf("### wait: no ticket %s\n", args[0]);
+		return -1;
+	}
+	while(t->state == TICKET_ACTIVE) {
+		srio_async_poll();
+		cmd_idle_wait();
+	}
+	ret = (t->cc == SRIO_CC_OK) ? 0 : -1;
+	ticket_report(t);
+	return ret;
+}
+
+///////////////////////////////////////////////////////////////
+////////// pollFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int pollFunc(char *cmdStr)
+{
+	dbg_printf("POLL: %s\n", cmdStr);
+
+	SrioTicket	*t;
+	int			i, num = 0;
+
+	srio_async_poll();
+	for(i=0; i<SRIO_ASYNC_TICKETS; i++) {
+		t = &tickets[i];
+		if(t->state == TICKET_ACTIVE) {
+			printf("TICKET %lu: %s in progress, %lu of %lu bytes issued, %d requests pending\n",
+				t->id, t->name, t->issued, t->x.size, t->num);
+			num++;
+		}
+		else if(t->state == TICKET_DONE) {
+			ticket_report(t);
+		}
+	}
+	printf("POLL: %d ticket(s) in progress\n", num);
+	return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ *  srio_async.h
+ *
+ *  Asynchronous (ticketed) SRIO commands of the SRIO Command Monitor.
+ */
+#ifndef SRIO_ASYNC_H_
+#define SRIO_ASYNC_H_
+
+#include <stdint.h>
+#include "srio_xfer.h"
+
+/* Max tickets in progress */
+#define SRIO_ASYNC_TICKETS		16
+
+/* Ticket fails if there is no progress during this time (us) */
+#define SRIO_ASYNC_TIMEOUT_US	1000000
+
+/* srio_async_submit() flags */
+#define SRIO_ASYNC_WORD			0x01	/* one word, data is kept in the ticket */
+#define SRIO_ASYNC_STRIPE		0x02	/* spread the requests over the ports */
+
+/* Ticket states */
+#define TICKET_FREE				0
+#define TICKET_ACTIVE			1
+#define TICKET_DONE				2
+
+/** Asynchronous command in progress */
+typedef struct
+{
+	uint32_t	id;				/* ticket number */
+	uint8_t		state;			/* TICKET_xxx */
+	uint8_t		flags;			/* SRIO_ASYNC_xxx */
+	uint8_t		cls;			/* priority class */
+	char		name[8];		/* command name */
+	SrioXfer	x;				/* whole transfer */
+	uint32_t	chunk;			/* bytes per LSU request */
+	uint32_t	issued;			/* bytes issued */
+	SrioOp		ops[SRIO_STRIPE_WINDOW];
+	int			first;			/* oldest request in progress */
+	int			num;			/* requests in progress */
+	int			cc;				/* first error code */
+	uint32_t	data;			/* word data (SRIO_ASYNC_WORD) */
+	uint64_t	tscStart;
+	uint64_t	tscEnd;
+	uint64_t	tscProgress;	/* last completion or issue */
+} SrioTicket;
+
+extern int		async_mode;
+
+int		srio_async_submit(const char *name, const SrioXfer *x, int cls, uint32_t chunk, int flags);
+void	srio_async_poll(void);
+int		asyncFunc(char *cmdStr);
+int		waitFunc(char *cmdStr);
+int		pollFunc(char *cmdStr);
+
+#endif /* SRIO_ASYNC_H_ */
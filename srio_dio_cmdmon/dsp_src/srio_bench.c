@@ -0,0 +1,381 @@
+/*
+ *  srio_bench.c
+ *
+ *  SRIO performance measurement commands of the SRIO Command Monitor.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+#include <prf/sys6678.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_async.h"
+#include "srio_bench.h"
+
+/** Window of outstanding LSU requests */
+typedef struct
+{
+	SrioOp		op[BENCH_WINDOW];
+	int			first;			/* oldest request */
+	int			num;			/* requests in progress */
+	uint32_t	errors;			/* completed with error */
+} OpWindow;
+
+/*********************** win_wait_one ********************
+* Wait for the oldest request of the window
+****************************************************/
+static int	win_wait_one(OpWindow *w)
+{
+	int		cc;
+
+	cc = srio_xfer_wait(&w->op[w->first]);
+	if(cc != SRIO_CC_OK) w->errors++;
+	w->first = (w->first + 1) % BENCH_WINDOW;
+	w->num--;
+	return cc;
+}
+
+/*********************** win_issue ********************
+* Issue the request, waiting for the oldest one if the window is full
+****************************************************/
+static int	win_issue(OpWindow *w, int cls, const SrioDesc *d)
+{
+	int		cc;
+
+	if(w->num == BENCH_WINDOW) win_wait_one(w);
+	cc = srio_desc_issue(srio_lsu_select(cls), d, d->xfer.remoteAdr, d->xfer.localAdr, d->xfer.size,
+						 &w->op[(w->first + w->num) % BENCH_WINDOW]);
+	if(cc != SRIO_CC_OK) {
+		w->errors++;
+		return cc;
+	}
+	w->num++;
+	return SRIO_CC_OK;
+}
+
+/*********************** print_rate ********************
+****************************************************/
+static void	print_rate(const char *name, uint64_t bytes, uint64_t ticks)
+{
+	uint32_t	us = (uint32_t)(ticks / CPU_FREQ_MHZ);
+	uint32_t	rate = ticks ? (uint32_t)((bytes * CPU_FREQ_MHZ * 100) / ticks) : 0;	// MB/s * 100
+
+	printf("%s: %lu bytes in %lu us, %lu.%02lu MB/s\n", name, (uint32_t)bytes, us,
+		rate / 100, rate % 100);
+}
+
+/*********************** bench_stream ********************
+* Move count blocks of size bytes by NWRITE (local src -> own remote dst)
+* or NREAD (own remote src -> local dst) through the own device ID
+****************************************************/
+static uint64_t	bench_stream(uint8_t ftype, uint8_t ttype, uint32_t local, uint32_t remote,
+							 uint32_t size, uint32_t count, uint32_t *errors)
+{
+	OpWindow	w;
+	SrioXfer	x;
+	SrioDesc	d;
+	uint64_t	t0;
+	uint32_t	n;
+
+	memset(&w, 0, sizeof(w));
+	memset(&x, 0, sizeof(x));
+	x.destId	= main_deviceID;
+	x.idSize	= id_size;
+	x.ftype		= ftype;
+	x.ttype		= ttype;
+	x.remoteAdr	= remote;
+	x.localAdr	= local;
+	x.size		= size;
+	srio_xfer_class(&x, SRIO_CLASS_BULK);
+	srio_desc_build(&d, &x);
+
+	t0 = CSL_tscRead();
+	for(n=0; n<count; n++)
+		win_issue(&w, SRIO_CLASS_BULK, &d);
+	while(w.num)
+		win_wait_one(&w);
+
+	*errors = w.errors;
+	return CSL_tscRead() - t0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// selftestFunc() /////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int selftestFunc(char *cmdStr)
+{
+	dbg_printf("SELFTEST: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc;
+	char		*end;
+	uint32_t	size  = 4096;
+	uint32_t	count = 1000;
+	uint32_t	src   = BENCH_SRC_ADR;
+	uint32_t	dst   = BENCH_DST_ADR;
+	uint32_t	chk   = BENCH_CHK_ADR;
+	uint32_t	errors, i, bad;
+	uint64_t	ticks;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc > 0) size  = strtoul(args[0], &end, 10);
+	if(argc > 1) count = strtoul(args[1], &end, 10);
+	if(argc > 2) src   = strtoul(args[2], &end, 16);
+	if(argc > 3) dst   = strtoul(args[3], &end, 16);
+	if(argc > 4) chk   = strtoul(args[4], &end, 16);
+	if(size < 4 || size > BENCH_MAX_SIZE || (size & 3) || count == 0) {
+		printf("### selftest: bad size %lu (4..%lu, multiple of 4) or count %lu\n",
+			size, (uint32_t)BENCH_MAX_SIZE, count);
+		return -1;
+	}
+	src = srio_global_adr(src);
+	dst = srio_global_adr(dst);
+	chk = srio_global_adr(chk);
+
+	if(loopback_mode == SRIO_LOOPBACK_OFF)
+		printf("SELFTEST: warning - loopback is off, own ID packets must be returned by the fabric\n");
+	printf("SELFTEST: ID 0x%X, %lu x %lu bytes, src 0x%08lX, dst 0x%08lX, chk 0x%08lX\n",
+		main_deviceID, count, size, src, dst, chk);
+
+	for(i=0; i<size/4; i++) {
+		MEM(src + 4*i) = i ^ 0xA5A50000;
+		MEM(dst + 4*i) = 0;
+		MEM(chk + 4*i) = 0;
+	}
+	/* MSMC buffers are cached in L1D, the LSU reads/writes the memory */
+	CACHE_wbL1d((void *)src, size, CACHE_WAIT);
+	CACHE_wbL1d((void *)dst, size, CACHE_WAIT);
+	CACHE_wbInvL1d((void *)chk, size, CACHE_WAIT);
+
+	/* Throughput */
+	ticks = bench_stream(SRIO_FTYPE_NWRITE, SRIO_TTYPE_NWRITE, src, dst, size, count, &errors);
+	print_rate("NWRITE", (uint64_t)size * count, ticks);
+	if(errors) printf("### NWRITE: %lu errors\n", errors);
+
+	ticks = bench_stream(SRIO_FTYPE_NREAD, SRIO_TTYPE_NREAD, chk, dst, size, count, &errors);
+	print_rate("NREAD ", (uint64_t)size * count, ticks);
+	if(errors) printf("### NREAD: %lu errors\n", errors);
+
+	/* Latency of small NREAD (request and response) */
+	{
+		SrioXfer	x;
+		SrioDesc	d;
+		SrioOp		op;
+		uint32_t	lat, latMin = 0xFFFFFFFF, latMax = 0;
+		uint64_t	latSum = 0;
+		uint32_t	n, ok = 0;
+		int			cc;
+
+		memset(&x, 0, sizeof(x));
+		x.destId	= main_deviceID;
+		x.idSize	= id_size;
+		x.ftype		= SRIO_FTYPE_NREAD;
+		x.ttype		= SRIO_TTYPE_NREAD;
+		x.remoteAdr	= dst;
+		x.localAdr	= chk;
+		x.size		= 4;
+		srio_xfer_class(&x, SRIO_CLASS_CTRL);
+		srio_desc_build(&d, &x);
+
+		for(n=0; n<count; n++) {
+			if(srio_desc_issue(srio_lsu_select(SRIO_CLASS_CTRL), &d, dst, chk, 4, &op) != SRIO_CC_OK)
+				continue;
+			cc  = srio_xfer_wait(&op);
+			lat = (uint32_t)(CSL_tscRead() - op.tscIssue);
+			if(cc != SRIO_CC_OK) continue;
+			if(lat < latMin) latMin = lat;
+			if(lat > latMax) latMax = lat;
+			latSum += lat;
+			ok++;
+		}
+		if(ok)
+			printf("LATENCY: NREAD 4 bytes min %lu ns, avg %lu ns, max %lu ns (%lu of %lu)\n",
+				(latMin * 1000) / CPU_FREQ_MHZ, (uint32_t)((latSum * 1000) / ok / CPU_FREQ_MHZ),
+				(latMax * 1000) / CPU_FREQ_MHZ, ok, count);
+		else
+			printf("### LATENCY: no NREAD completed\n");
+	}
+
+	/* Data check: src -> (NWRITE) dst -> (NREAD) chk */
+	CACHE_invL1d((void *)chk, size, CACHE_WAIT);
+	for(i=0, bad=0; i<size/4; i++)
+		if(MEM(chk + 4*i) != MEM(src + 4*i)) bad++;
+	if(bad)	printf("### DATA: %lu of %lu words are bad\n", bad, size/4);
+	else	printf("DATA: OK\n");
+
+	return bad ? -1 : 0;
+}
+
+/*********************** block_xfer ********************
+* bwrite/bread: <IdHex> <AdrHex> <LocalAdrHex> <SizeDec> [ChunkDec]
+****************************************************/
+static int	block_xfer(const char *name, uint8_t ftype, uint8_t ttype, char *cmdStr)
+{
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, cc;
+	char		*end;
+	SrioXfer	x;
+	uint32_t	chunk = 0;
+	uint32_t	bytes[4];
+	uint64_t	t0, ticks;
+	uint8_t		port, mask;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc < 4) {
+		printf("### %s: bad arguments '%s'\n", name, cmdStr);
+		return -1;
+	}
+	memset(&x, 0, sizeof(x));
+	x.destId = strtoul(args[0], &end, 16);
+	if(srio_addr_parse(args[1], addr_bits, &x) < 0) {
+		printf("### %s: bad %d-bit address '%s' (see 'addr')\n", name, addr_bits, args[1]);
+		return -1;
+	}
+	x.localAdr = srio_global_adr(strtoul(args[2], &end, 16));
+	x.size     = strtoul(args[3], &end, 10);
+	if(argc > 4) chunk = strtoul(args[4], &end, 10);
+	if(x.size == 0 || x.remoteAdr + x.size - 1 < x.remoteAdr) {
+		printf("### %s: bad size %lu (block can't cross 4 GB boundary)\n", name, x.size);
+		return -1;
+	}
+	if(id_size == SRIO_ID_8BIT && x.destId > 0xFF) {
+		printf("### %s: ID 0x%X is too large for 8-bit ID size (see 'idsize')\n", name, x.destId);
+		return -1;
+	}
+	x.idSize = id_size;
+	x.ftype  = ftype;
+	x.ttype  = ttype;
+	srio_xfer_class(&x, SRIO_CLASS_BULK);
+
+	if(async_mode)
+		return (srio_async_submit(name, &x, SRIO_CLASS_BULK, chunk, SRIO_ASYNC_STRIPE) < 0) ? -1 : 0;
+
+	mask = srio_port_eligible(x.destId);
+	memcpy(bytes, srio_port_bytes, sizeof(bytes));
+
+	t0 = CSL_tscRead();
+	cc = srio_xfer_stripe(&x, SRIO_CLASS_BULK, chunk);
+	ticks = CSL_tscRead() - t0;
+
+	if(cc != SRIO_CC_OK) {
+		printf("### %s Error: %s\n", name, srio_cc_str(cc));
+		return -1;
+	}
+	print_rate(name, x.size, ticks);
+	for(port=0; port<4; port++)
+		if((mask >> port) & 1)
+			printf("  port %d: %lu bytes\n", port, srio_port_bytes[port] - bytes[port]);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// bwriteFunc() / breadFunc() /////////////////////////
+///////////////////////////////////////////////////////////////
+int bwriteFunc(char *cmdStr)
+{
+	dbg_printf("BWRITE: %s\n", cmdStr);
+	return block_xfer("BWRITE", SRIO_FTYPE_NWRITE, SRIO_TTYPE_NWRITE, cmdStr);
+}
+
+int breadFunc(char *cmdStr)
+{
+	dbg_printf("BREAD: %s\n", cmdStr);
+	return block_xfer("BREAD", SRIO_FTYPE_NREAD, SRIO_TTYPE_NREAD, cmdStr);
+}
+
+/*********************** parse_id_list ********************
+* Parse "<IdHex>[-<IdHex>][,...]" into ids, return number of IDs or -1
+****************************************************/
+int	parse_id_list(const char *str, uint16_t *ids, int max)
+{
+	char		*end;
+	uint32_t	id, last;
+	int			num = 0;
+
+	while(*str) {
+		id = last = strtoul(str, &end, 16);
+		if(end == str) return -1;
+		if(*end == '-') {
+			str  = end + 1;
+			last = strtoul(str, &end, 16);
+			if(end == str || last < id) return -1;
+		}
+		for(; id <= last; id++) {
+			if(num == max) return -1;
+			ids[num++] = id;
+		}
+		if(*end == ',') end++;
+		else if(*end) return -1;
+		str = end;
+	}
+	return num;
+}
+
+///////////////////////////////////////////////////////////////
+////////// bcastFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int bcastFunc(char *cmdStr)
+{
+	dbg_printf("BCAST: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, num, i, errors;
+	char		*end;
+	SrioXfer	x;
+	uint16_t	ids[SRIO_BCAST_MAX];
+	int			cc[SRIO_BCAST_MAX];
+	uint32_t	chunk = 0;
+	uint64_t	t0, ticks;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc < 4) {
+		printf("### bcast: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+	num = parse_id_list(args[0], ids, SRIO_BCAST_MAX);
+	if(num <= 0) {
+		printf("### bcast: bad ID list '%s' (e.g. 1,4-7, max %d IDs)\n", args[0], SRIO_BCAST_MAX);
+		return -1;
+	}
+	memset(&x, 0, sizeof(x));
+	if(srio_addr_parse(args[1], addr_bits, &x) < 0) {
+		printf("### bcast: bad %d-bit address '%s' (see 'addr')\n", addr_bits, args[1]);
+		return -1;
+	}
+	x.localAdr = srio_global_adr(strtoul(args[2], &end, 16));
+	x.size     = strtoul(args[3], &end, 10);
+	if(argc > 4) chunk = strtoul(args[4], &end, 10);
+	if(x.size == 0 || x.remoteAdr + x.size - 1 < x.remoteAdr) {
+		printf("### bcast: bad size %lu (block can't cross 4 GB boundary)\n", x.size);
+		return -1;
+	}
+	for(i=0; i<num; i++) {
+		if(id_size == SRIO_ID_8BIT && ids[i] > 0xFF) {
+			printf("### bcast: ID 0x%X is too large for 8-bit ID size (see 'idsize')\n", ids[i]);
+			return -1;
+		}
+	}
+	x.idSize = id_size;
+	x.ftype  = SRIO_FTYPE_NWRITE;
+	x.ttype  = SRIO_TTYPE_NWRITE;
+	srio_xfer_class(&x, SRIO_CLASS_BULK);
+
+	t0 = CSL_tscRead();
+	errors = srio_xfer_bcast(&x, ids, num, SRIO_CLASS_BULK, chunk, cc);
+	ticks = CSL_tscRead() - t0;
+
+	print_rate("BCAST", (uint64_t)x.size * (num - errors), ticks);
+	for(i=0; i<num; i++)
+		if(cc[i] != SRIO_CC_OK)
+			printf("### BCAST 0x%X Error: %s\n", ids[i], srio_cc_str(cc[i]));
+	printf("BCAST: %d of %d destinations OK\n", num - errors, num);
+	return errors ? -1 : 0;
+}
@@ -0,0 +1,26 @@
+/*
+ *  srio_bench.h
+ *
+ *  SRIO performance measurement commands of the SRIO Command Monitor.
+ */
+#ifndef SRIO_BENCH_H_
+#define SRIO_BENCH_H_
+
+#include <stdint.h>
+
+/* Default buffers of the benchmarks (MSMC SRAM) */
+#define BENCH_SRC_ADR			0x0C000000
+#define BENCH_DST_ADR			0x0C100000
+#define BENCH_CHK_ADR			0x0C200000
+#define BENCH_MAX_SIZE			0x100000
+
+/* Max outstanding LSU requests of the benchmarks */
+#define BENCH_WINDOW			8
+
+int		selftestFunc(char *cmdStr);
+int		bwriteFunc(char *cmdStr);
+int		breadFunc(char *cmdStr);
+int		bcastFunc(char *cmdStr);
+int		parse_id_list(const char *str, uint16_t *ids, int max);
+
+#endif /* SRIO_BENCH_H_ */
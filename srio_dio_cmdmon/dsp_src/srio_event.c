@@ -0,0 +1,223 @@
+/*
+ *  srio_event.c
+ *
+ *  Port-write reception and asynchronous SRIO error events.
+ *
+ *  Port-writes received from the fabric and the local logical and physical
+ *  layer error detections are captured into a timestamped queue by poll:
+ *  from the command loop and, through cmd_idle(), every millisecond of a
+ *  long running command. The BIOS is not started, so no interrupt is used.
+ *  The 'events' command drains the queue.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_srioAuxPhyLayer.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_event.h"
+
+#define EVENT_MASK			(SRIO_EVENT_SIZE-1)
+
+static SrioEvent			event_queue[SRIO_EVENT_SIZE];
+static uint32_t				event_head = 0;		// written by event_scan()
+static uint32_t				event_tail = 0;		// written by 'events' command
+static uint32_t				event_lost = 0;
+static uint32_t				event_reported = 0;	// head at last notice
+static uint8_t				port_stopped[4];
+
+/*********************** event_push ********************
+* Add the event to the queue
+****************************************************/
+static void	event_push(uint8_t type, uint8_t port,
+					   uint32_t d0, uint32_t d1, uint32_t d2, uint32_t d3)
+{
+	SrioEvent	*e;
+
+	if(event_head - event_tail >= SRIO_EVENT_SIZE) {
+		event_lost++;
+		return;
+	}
+	e = &event_queue[event_head & EVENT_MASK];
+	e->tsc     = CSL_tscRead();
+	e->type    = type;
+	e->port    = port;
+	e->data[0] = d0;
+	e->data[1] = d1;
+	e->data[2] = d2;
+	e->data[3] = d3;
+	event_head++;
+}
+
+/*********************** event_scan ********************
+* Capture the port-write and the error detections and clear them
+****************************************************/
+static void	event_scan(void)
+{
+	uint32_t	det, stat;
+	uint8_t		port, stopped;
+
+	/* Port-write: component tag, port error detect, port ID, LTL error detect */
+	if(hSrio->RIO_PW_RX_STAT & SRIO_PW_RX_STAT_VAL) {
+		event_push(SRIO_EV_PORT_WRITE, 0,
+				   hSrio->RIO_PW_RX_CAPT[0], hSrio->RIO_PW_RX_CAPT[1],
+				   hSrio->RIO_PW_RX_CAPT[2], hSrio->RIO_PW_RX_CAPT[3]);
+		hSrio->RIO_PW_RX_STAT = SRIO_PW_RX_STAT_VAL;		// release capture registers
+	}
+
+	/* Logical/transport layer errors */
+	det = hSrio->RIO_ERR_DET;
+	if(det) {
+		event_push(SRIO_EV_LL_ERROR, 0, det, 0, 0, 0);
+		hSrio->RIO_ERR_DET = 0;
+	}
+
+	/* Physical layer errors and error-stopped state */
+	for(port=0; port<4; port++) {
+		stat = hSrio->RIO_SP[port].RIO_SP_ERR_STAT;
+		det  = hSrio->RIO_SP_ERR[port].RIO_SP_ERR_DET;
+		if(det) {
+			event_push(SRIO_EV_PORT_ERROR, port, det, stat,
+					   hSrio->RIO_SP_ERR[port].RIO_SP_ERR_ATTR_CAPT_DBG0,
+					   hSrio->RIO_SP_ERR[port].RIO_SP_ERR_CAPT_0_DBG1);
+			hSrio->RIO_SP_ERR[port].RIO_SP_ERR_DET = 0;
+		}
+		stopped = (stat & (SRIO_SP_ERR_STAT_INPUT_STOPPED | SRIO_SP_ERR_STAT_OUTPUT_STOPPED)) ? 1 : 0;
+		if(stopped != port_stopped[port]) {
+			event_push(SRIO_EV_PORT_STOPPED, port, stopped, stat, 0, 0);
+			port_stopped[port] = stopped;
+		}
+	}
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Enable the error detection and the port-write reception.
+ *      Called after SrioDevice_init().
+ *
+ *  @retval
+ *      Success - 0
+ */
+int	srio_event_init(void)
+{
+	uint8_t		port;
+
+	/* Port-write reception capture of every port, SrioDevice_init() leaves it off;
+	 * release the capture registers and clear old detections */
+	for(port=0; port<4; port++)
+		CSL_SRIO_SetPortWriteReceptionCapture(hSrio, port, 1);
+	hSrio->RIO_PW_RX_STAT = SRIO_PW_RX_STAT_VAL;
+	hSrio->RIO_ERR_DET = 0;
+	for(port=0; port<4; port++) {
+		hSrio->RIO_SP_ERR[port].RIO_SP_ERR_DET = 0;
+		port_stopped[port] = 0;
+	}
+
+	/* Enable detection of all logical and physical layer errors */
+	CSL_SRIO_SetErrorEnable(hSrio, 0xFFFFFFFF);
+	for(port=0; port<4; port++)
+		hSrio->RIO_SP_ERR[port].RIO_SP_RATE_EN = 0xFFFFFFFF;
+
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Capture the new events and report them. Called from the command
+ *      loop and from cmd_idle().
+ */
+void	srio_event_poll(void)
+{
+	uint32_t	head;
+
+	event_scan();
+
+	head = event_head;
+	if(head != event_reported) {
+		printf("### SRIO: %lu new event(s), use 'events' to view\n", head - event_reported);
+		event_reported = head;
+	}
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Number of events in the queue.
+ */
+uint32_t	srio_event_pending(void)
+{
+	return event_head - event_tail;
+}
+
+///////////////////////////////////////////////////////////////
+////////// eventsFunc() ///////////////////////////////////////
+///////////////////////////////////////////////////////////////
+static void	event_print(const SrioEvent *e)
+{
+	uint32_t	us = (uint32_t)(e->tsc / CPU_FREQ_MHZ);
+
+	printf("%12lu ", us);
+	switch(e->type) {
+	case SRIO_EV_PORT_WRITE:
+		printf("PORT-WRITE  tag 0x%08lX, port %lu, ERR_DET 0x%08lX, LTL_ERR_DET 0x%08lX (impl 0x%02lX)\n",
+			e->data[0], e->data[2] & 0xFF, e->data[1], e->data[3], e->data[2] >> 24);
+		break;
+	case SRIO_EV_LL_ERROR:
+		printf("LL-ERROR    ERR_DET 0x%08lX\n", e->data[0]);
+		break;
+	case SRIO_EV_PORT_ERROR:
+		printf("PORT-ERROR  port %d, SP_ERR_DET 0x%08lX, SP_ERR_STAT 0x%08lX, ATTR 0x%08lX, CAPT 0x%08lX\n",
+			e->port, e->data[0], e->data[1], e->data[2], e->data[3]);
+		break;
+	case SRIO_EV_PORT_STOPPED:
+		printf("PORT-%s port %d, SP_ERR_STAT 0x%08lX\n",
+			e->data[0] ? "STOP   " : "RESUME ", e->port, e->data[1]);
+		break;
+	default:
+		printf("UNKNOWN %d\n", e->type);
+		break;
+	}
+}
+
+int eventsFunc(char *cmdStr)
+{
+	dbg_printf("EVENTS: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc;
+	SrioEvent	e;
+	uint32_t	num = 0;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	event_scan();
+
+	if(argc > 0 && strcmp(args[0], "clr") == 0) {
+		event_tail = event_head;
+		event_lost = 0;
+	}
+	else if(argc > 0) {
+		printf("### events: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+	else {
+		printf("    TIME(us) EVENT\n");
+		while(event_tail != event_head) {
+			memcpy(&e, &event_queue[event_tail & EVENT_MASK], sizeof(e));
+			event_tail++;
+			event_print(&e);
+			num++;
+		}
+	}
+	event_reported = event_head;
+
+	printf("EVENTS: %lu printed, %lu lost\n", num, event_lost);
+	return 0;
+}
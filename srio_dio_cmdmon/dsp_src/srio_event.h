@@ -0,0 +1,41 @@
+/*
+ *  srio_event.h
+ *
+ *  Port-write reception and asynchronous SRIO error events.
+ */
+#ifndef SRIO_EVENT_H_
+#define SRIO_EVENT_H_
+
+#include <stdint.h>
+
+/* Number of entries in event queue (must be power of 2) */
+#define SRIO_EVENT_SIZE			64
+
+/* RIO_PW_RX_STAT */
+#define SRIO_PW_RX_STAT_VAL		0x00000001	/* port-write captured */
+
+/* RIO_SP_ERR_STAT */
+#define SRIO_SP_ERR_STAT_INPUT_STOPPED	0x00000100
+#define SRIO_SP_ERR_STAT_OUTPUT_STOPPED	0x00010000
+
+/* Event types */
+#define SRIO_EV_PORT_WRITE		1	/* port-write received from fabric */
+#define SRIO_EV_LL_ERROR		2	/* logical/transport layer error (RIO_ERR_DET) */
+#define SRIO_EV_PORT_ERROR		3	/* physical layer error (RIO_SP_ERR_DET) */
+#define SRIO_EV_PORT_STOPPED	4	/* port entered/left error-stopped state */
+
+/** Event queue entry */
+typedef struct
+{
+	uint64_t	tsc;			/* CSL_tscRead() at capture time */
+	uint8_t		type;			/* SRIO_EV_xxx */
+	uint8_t		port;			/* local port (port errors) */
+	uint32_t	data[4];		/* port-write payload / error registers */
+} SrioEvent;
+
+int		srio_event_init(void);
+void	srio_event_poll(void);
+uint32_t	srio_event_pending(void);
+int		eventsFunc(char *cmdStr);
+
+#endif /* SRIO_EVENT_H_ */
@@ -0,0 +1,257 @@
+/*
+ *  srio_link.c
+ *
+ *  SRIO link health supervisor of the SRIO Command Monitor.
+ *
+ *  The supervisor runs from the command loop poll and, through cmd_idle(),
+ *  from the long running commands and LSU waits. It watches the port
+ *  OK and error-stopped states of the supervised ports. On failure the
+ *  LSU requests using the port are flushed (their waiters fail with
+ *  SRIO_CC_LINK_DOWN), the ackIDs are resynchronized with the link
+ *  partner by link-request/input-status, and if the port is still not
+ *  OK it is reset by the port disable bit.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_srioAuxPhyLayer.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_trace.h"
+#include "srio_link.h"
+
+#define US_TO_TSC(us)		((uint64_t)(us) * CPU_FREQ_MHZ)
+
+uint8_t			srio_link_mask = 0x1;	// one 4x port
+int				srio_link_auto = 1;
+
+static SrioLinkState	link_state[4] = { { 1 }, { 1 }, { 1 }, { 1 } };
+
+/**
+ *  @b Description
+ *  @n
+ *      Check that the port is initialized and not error-stopped.
+ *
+ *  @retval
+ *      1 - port is OK
+ *  @retval
+ *      0 - port is down or error-stopped
+ */
+int	srio_link_ok(uint8_t port)
+{
+	uint32_t	stat = hSrio->RIO_SP[port].RIO_SP_ERR_STAT;
+
+	if((stat & SRIO_SP_ERR_STAT_PORT_OK) == 0) return 0;
+	if(stat & (SRIO_SP_ERR_STAT_IN_STOPPED | SRIO_SP_ERR_STAT_OUT_STOPPED)) return 0;
+	return 1;
+}
+
+/*********************** link_wait_ok ********************
+* Wait for the port OK state up to us microseconds
+****************************************************/
+static int	link_wait_ok(uint8_t port, uint32_t us)
+{
+	uint64_t	tscEnd = CSL_tscRead() + US_TO_TSC(us);
+
+	do {
+		if(srio_link_ok(port)) return 1;
+	} while(CSL_tscRead() < tscEnd);
+	return 0;
+}
+
+/*********************** link_input_status ********************
+* Send link-request/input-status and resynchronize the ackIDs
+* with the link partner. Return -1 if there is no response.
+****************************************************/
+static int	link_input_status(uint8_t port)
+{
+	uint64_t	tscEnd;
+	uint32_t	resp, ackid, inb;
+
+	(void)hSrio->RIO_SP[port].RIO_SP_LM_RESP;		// drop old response
+	hSrio->RIO_SP[port].RIO_SP_LM_REQ = SRIO_LM_CMD_INPUT_STATUS;
+
+	tscEnd = CSL_tscRead() + US_TO_TSC(SRIO_LINK_LM_TIMEOUT_US);
+	do {
+		resp = hSrio->RIO_SP[port].RIO_SP_LM_RESP;
+		if(resp & SRIO_LM_RESP_VALID) break;
+	} while(CSL_tscRead() < tscEnd);
+	if((resp & SRIO_LM_RESP_VALID) == 0)
+		return -1;
+
+	/* Next ackID expected by the partner becomes our outstanding and outbound ackID */
+	ackid = SRIO_LM_RESP_ACKID(resp);
+	inb   = (hSrio->RIO_SP[port].RIO_SP_ACKID_STAT >> 24) & 0x3F;
+	hSrio->RIO_SP[port].RIO_SP_ACKID_STAT = (inb << 24) | (ackid << 8) | ackid;
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Flush the LSU requests of this core to the port. Only the LSUs with
+ *      requests to this port alone are killed (see srio_lsu_shared()); the
+ *      requests of the port on an LSU shared with other ports end by the
+ *      LSU response timeout, and their waiters see the link failure.
+ */
+void	srio_lsu_flush(uint8_t port)
+{
+	uint8_t		lsu;
+
+	for(lsu=0; lsu<SRIO_LSU_NUM; lsu++) {
+		if(srio_lsu_busy[lsu][port] == 0 || srio_lsu_shared(lsu, port)) continue;
+		CSL_SRIO_KillLSUTransaction (hSrio, lsu, DNUM);
+		srio_lsu_busy[lsu][port] = 0;
+	}
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Bring the failed port back: flush the LSUs, clear the error state,
+ *      resynchronize the ackIDs by link-request/input-status and reset
+ *      the port if it is still not OK.
+ *
+ *  @param[in]  port
+ *      Port number (0..3).
+ *
+ *  @retval
+ *      Success - 0
+ *  @retval
+ *      Error   - <0 (port is still down)
+ */
+int	srio_link_recover(uint8_t port)
+{
+	SrioLinkState	*s = &link_state[port];
+	uint64_t		t0 = CSL_tscRead();
+	uint32_t		stat;
+
+	srio_lsu_flush(port);
+
+	/* Clear sticky error bits, leaving error-stopped state needs input-status */
+	stat = hSrio->RIO_SP[port].RIO_SP_ERR_STAT;
+	hSrio->RIO_SP[port].RIO_SP_ERR_STAT = stat & SRIO_SP_ERR_STAT_W1C;
+
+	if(link_input_status(port) == 0 && link_wait_ok(port, SRIO_LINK_SETTLE_US))
+		goto recovered;
+
+	/* Port reset */
+	s->resets++;
+	hSrio->RIO_SP[port].RIO_SP_CTL |= SRIO_SP_CTL_PORT_DIS;
+	link_wait_ok(port, 10);		// short delay, the port is disabled
+	hSrio->RIO_SP[port].RIO_SP_CTL &= ~SRIO_SP_CTL_PORT_DIS;
+	CSL_SRIO_EnableInputPort (hSrio, port);
+	CSL_SRIO_EnableOutputPort (hSrio, port);
+
+	if(link_wait_ok(port, SRIO_LINK_RESET_US) == 0) {
+		s->failures++;
+		return -1;
+	}
+	link_input_status(port);
+
+recovered:
+	s->recoveries++;
+	s->lastUs = (uint32_t)((CSL_tscRead() - t0) / CPU_FREQ_MHZ);
+	srio_trace_rec(TRC_EV_PORT, port, 0, hSrio->RIO_SP[port].RIO_SP_ERR_STAT, 0, 0, 1, 0, 0);
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Check the supervised ports and recover the failed ones.
+ *      Called periodically from the command loop.
+ */
+void	srio_link_poll(void)
+{
+	SrioLinkState	*s;
+	uint8_t			port;
+
+	for(port=0; port<4; port++) {
+		if(((srio_link_mask >> port) & 1) == 0) continue;
+		s = &link_state[port];
+
+		if(srio_link_ok(port)) {
+			if(s->up == 0) {
+				printf("SRIO: port %d is up\n", port);
+				s->up = 1;
+			}
+			continue;
+		}
+
+		if(s->up) {
+			s->up = 0;
+			s->drops++;
+			s->tscDown = CSL_tscRead();
+			s->tscRetry = 0;
+			printf("### SRIO: port %d is down (SP_ERR_STAT = 0x%08lX)\n",
+				port, hSrio->RIO_SP[port].RIO_SP_ERR_STAT);
+		}
+		if(srio_link_auto == 0 || CSL_tscRead() < s->tscRetry) continue;
+
+		if(srio_link_recover(port) == 0) {
+			printf("SRIO: port %d recovered in %lu us\n", port, s->lastUs);
+			s->up = 1;
+		} else {
+			s->tscRetry = CSL_tscRead() + US_TO_TSC(SRIO_LINK_RETRY_US);
+		}
+	}
+}
+
+///////////////////////////////////////////////////////////////
+////////// linkFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int linkFunc(char *cmdStr)
+{
+	dbg_printf("LINK: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc;
+	char		*end;
+	uint8_t		port;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+
+	if(argc > 0 && strcmp(args[0], "auto") == 0 && argc > 1) {
+		srio_link_auto = (strcmp(args[1], "on") == 0) ? 1 : 0;
+	}
+	else if(argc > 1 && strcmp(args[0], "recover") == 0) {
+		port = strtoul(args[1], &end, 10);
+		if(port > 3) {
+			printf("### link: bad port %d\n", port);
+			return -1;
+		}
+		if(srio_link_recover(port) < 0) {
+			printf("### link: port %d is not recovered\n", port);
+			return -1;
+		}
+		link_state[port].up = 1;
+		printf("LINK: port %d recovered in %lu us\n", port, link_state[port].lastUs);
+	}
+	else if(argc > 1 && strcmp(args[0], "mask") == 0) {
+		srio_link_mask = strtoul(args[1], &end, 16) & 0xF;
+	}
+	else if(argc > 0) {
+		printf("### link: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	printf("LINK: supervisor %s, ports mask 0x%X\n", srio_link_auto ? "auto" : "manual", srio_link_mask);
+	printf("PORT STATE  SP_ERR_STAT  ACKID_STAT  DROPS  RECOVERED  RESETS  FAILED  LAST(us)\n");
+	for(port=0; port<4; port++) {
+		SrioLinkState	*s = &link_state[port];
+		printf("%4d %-5s  0x%08lX   0x%08lX  %5lu  %9lu  %6lu  %6lu  %8lu%s\n", port,
+			srio_link_ok(port) ? "OK" : "DOWN",
+			hSrio->RIO_SP[port].RIO_SP_ERR_STAT, hSrio->RIO_SP[port].RIO_SP_ACKID_STAT,
+			s->drops, s->recoveries, s->resets, s->failures, s->lastUs,
+			((srio_link_mask >> port) & 1) ? "" : "  (not supervised)");
+	}
+	return 0;
+}
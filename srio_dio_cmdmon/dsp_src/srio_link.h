@@ -0,0 +1,57 @@
+/*
+ *  srio_link.h
+ *
+ *  SRIO link health supervisor of the SRIO Command Monitor.
+ */
+#ifndef SRIO_LINK_H_
+#define SRIO_LINK_H_
+
+#include <stdint.h>
+
+/* RIO_SP_ERR_STAT */
+#define SRIO_SP_ERR_STAT_PORT_OK		0x00000002
+#define SRIO_SP_ERR_STAT_PORT_ERR		0x00000004
+#define SRIO_SP_ERR_STAT_IN_STOPPED		0x00000100
+#define SRIO_SP_ERR_STAT_OUT_STOPPED	0x00010000
+#define SRIO_SP_ERR_STAT_W1C			0x07120204	/* sticky write-1-to-clear bits */
+
+/* RIO_SP_LM_REQ / RIO_SP_LM_RESP */
+#define SRIO_LM_CMD_INPUT_STATUS		4
+#define SRIO_LM_RESP_VALID				0x80000000
+#define SRIO_LM_RESP_ACKID(resp)		(((resp) >> 5) & 0x3F)
+
+/* RIO_SP_CTL */
+#define SRIO_SP_CTL_PORT_DIS			0x00800000
+
+/* Supervisor timing (us) */
+#define SRIO_LINK_LM_TIMEOUT_US			100		/* link-request response */
+#define SRIO_LINK_SETTLE_US				1000	/* port OK after ackID resync */
+#define SRIO_LINK_RESET_US				10000	/* port OK after port reset */
+#define SRIO_LINK_RETRY_US				100000	/* between failed recoveries */
+
+/* LSU wait loop spins between the link checks */
+#define SRIO_LINK_CHECK_SPINS			1024
+
+/** Link state and statistics of one port */
+typedef struct
+{
+	uint8_t		up;				/* port is OK and not error-stopped */
+	uint32_t	drops;			/* OK -> failed transitions */
+	uint32_t	recoveries;		/* successful recoveries */
+	uint32_t	resets;			/* port resets done by recovery */
+	uint32_t	failures;		/* failed recovery attempts */
+	uint32_t	lastUs;			/* duration of last recovery */
+	uint64_t	tscDown;		/* TSC of last drop */
+	uint64_t	tscRetry;		/* TSC of next allowed recovery */
+} SrioLinkState;
+
+extern uint8_t	srio_link_mask;		/* supervised ports */
+extern int		srio_link_auto;		/* recover automatically */
+
+int		srio_link_ok(uint8_t port);
+int		srio_link_recover(uint8_t port);
+void	srio_link_poll(void);
+void	srio_lsu_flush(uint8_t port);
+int		linkFunc(char *cmdStr);
+
+#endif /* SRIO_LINK_H_ */
@@ -0,0 +1,350 @@
+/*
+ *  srio_load.c
+ *
+ *  Mixed traffic load generator of the SRIO Command Monitor.
+ *
+ *  The profile gives the destinations (used round robin), the weights
+ *  of NWRITE, NREAD and maintenance read requests, the NWRITE/NREAD
+ *  sizes (powers of 2, equally likely), the offered request rate and the
+ *  number of outstanding requests. Requests are issued through the
+ *  precomputed descriptors, data on the bulk class LSUs and maintenance
+ *  on the control class LSUs. Every interval the achieved rate, the
+ *  latency percentiles (issue to completion) and the errors are printed.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_bench.h"
+#include "srio_load.h"
+
+#define TICKS_PER_SEC		((uint64_t)CPU_FREQ_MHZ * 1000000)
+
+/** Request in progress */
+typedef struct
+{
+	SrioOp		op;
+	uint8_t		type;			/* LOAD_xxx */
+	uint8_t		busy;
+} LoadOp;
+
+static uint32_t	load_seed = 0x2545F491;
+
+/*********************** load_rand ********************
+* xorshift32
+****************************************************/
+static uint32_t	load_rand(void)
+{
+	uint32_t	x = load_seed;
+
+	x ^= x << 13;
+	x ^= x >> 17;
+	x ^= x << 5;
+	return load_seed = x;
+}
+
+/*********************** lat_bucket ********************
+* Histogram bucket of the latency: exact below 8 ticks, then 4 per octave
+****************************************************/
+static int	lat_bucket(uint32_t t)
+{
+	int		e;
+
+	if(t < 8) return t;
+	e = 31 - _lmbd(1, t);
+	return (e << 2) | ((t >> (e - 2)) & 3);
+}
+
+/*********************** lat_bucket_top ********************
+* Largest latency of the bucket (ticks)
+****************************************************/
+static uint32_t	lat_bucket_top(int b)
+{
+	int		e = b >> 2;
+
+	if(b < 8) return b;
+	return (((4 | (b & 3)) + 1) << (e - 2)) - 1;
+}
+
+/*********************** lat_pct ********************
+* Latency percentile (pm - per mille) of the histogram in ns
+****************************************************/
+static uint32_t	lat_pct(const LoadStat *s, uint32_t num, uint32_t pm)
+{
+	uint32_t	need = (uint32_t)(((uint64_t)num * pm + 999) / 1000);
+	uint32_t	sum = 0, top;
+	int			b;
+
+	for(b=0; b<LOAD_HIST_NUM; b++) {
+		sum += s->hist[b];
+		if(sum >= need) break;
+	}
+	top = (b < LOAD_HIST_NUM) ? lat_bucket_top(b) : s->latMax;
+	if(top > s->latMax) top = s->latMax;
+	return (uint32_t)(((uint64_t)top * 1000) / CPU_FREQ_MHZ);
+}
+
+/*********************** load_report ********************
+****************************************************/
+static void	load_report(const char *name, const LoadStat *s, uint64_t ticks)
+{
+	uint32_t	ops = s->ops[LOAD_NWRITE] + s->ops[LOAD_NREAD] + s->ops[LOAD_MAINT];
+	uint32_t	errors = s->errors[LOAD_NWRITE] + s->errors[LOAD_NREAD] + s->errors[LOAD_MAINT];
+	uint32_t	rate = ticks ? (uint32_t)(((uint64_t)ops * TICKS_PER_SEC) / ticks) : 0;
+	uint32_t	mbs  = ticks ? (uint32_t)((s->bytes * CPU_FREQ_MHZ * 100) / ticks) : 0;	// MB/s * 100
+
+	printf("%s: %lu req/s, %lu.%02lu MB/s, W/R/M %lu/%lu/%lu", name, rate, mbs / 100, mbs % 100,
+		s->ops[LOAD_NWRITE], s->ops[LOAD_NREAD], s->ops[LOAD_MAINT]);
+	if(ops)
+		printf(", lat ns p50 %lu p90 %lu p99 %lu p99.9 %lu max %lu",
+			lat_pct(s, ops, 500), lat_pct(s, ops, 900), lat_pct(s, ops, 990), lat_pct(s, ops, 999),
+			(uint32_t)(((uint64_t)s->latMax * 1000) / CPU_FREQ_MHZ));
+	printf(", errors %lu (timeouts %lu), late %lu\n", errors, s->timeouts, s->late);
+}
+
+/*********************** load_add ********************
+****************************************************/
+static void	load_add(LoadStat *tot, const LoadStat *s)
+{
+	int		i;
+
+	for(i=0; i<LOAD_TYPES; i++) {
+		tot->ops[i]	   += s->ops[i];
+		tot->errors[i] += s->errors[i];
+	}
+	tot->timeouts += s->timeouts;
+	tot->late	  += s->late;
+	tot->bytes	  += s->bytes;
+	if(s->latMax > tot->latMax) tot->latMax = s->latMax;
+	for(i=0; i<LOAD_HIST_NUM; i++)
+		tot->hist[i] += s->hist[i];
+}
+
+/*********************** load_complete ********************
+* Check the request, 1 - it is done
+****************************************************/
+static int	load_complete(LoadOp *o, LoadStat *s)
+{
+	uint8_t		cc;
+	uint32_t	lat;
+
+	if(srio_xfer_done(&o->op, &cc) == 0) {
+		if(CSL_tscRead() - o->op.tscIssue <= (uint64_t)srio_xfer_policy.timeoutUs * CPU_FREQ_MHZ)
+			return 0;
+		srio_xfer_abort(&o->op);
+		s->timeouts++;
+		cc = SRIO_CC_SW_TIMEOUT;
+	}
+	o->busy = 0;
+	if(cc != SRIO_CC_OK) {
+		s->errors[o->type]++;
+		return 1;
+	}
+	lat = (uint32_t)(CSL_tscRead() - o->op.tscIssue);
+	s->ops[o->type]++;
+	s->bytes += o->op.xfer.size;
+	s->hist[lat_bucket(lat)]++;
+	if(lat > s->latMax) s->latMax = lat;
+	return 1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Run the traffic profile for p->seconds, printing the statistics of
+ *      every interval and of the whole run.
+ *
+ *  @retval
+ *      Success - 0
+ *  @retval
+ *      Error   - -1 (requests failed)
+ */
+int	srio_load_run(const LoadProfile *p)
+{
+	static SrioDesc	desc[LOAD_ID_MAX][LOAD_TYPES];	// static: too big for the 4K stack
+	static LoadOp	win[LOAD_WINDOW];
+	static LoadStat	iv, tot;
+	SrioXfer	x;
+	uint64_t	now, tStart, tEnd, tIv, tNext, period;
+	uint32_t	mixSum, r, size, num = 0, n, sec;
+	int			nSizes, i, type, slot, nextId = 0, cc;
+	char		name[16];
+	static const uint8_t	ftype[LOAD_TYPES] = { SRIO_FTYPE_NWRITE, SRIO_FTYPE_NREAD, SRIO_FTYPE_MAINT };
+	static const uint8_t	ttype[LOAD_TYPES] = { SRIO_TTYPE_NWRITE, SRIO_TTYPE_NREAD, SRIO_TTYPE_MAINT_RD };
+
+	for(i=0; i<p->numIds; i++) {
+		for(type=0; type<LOAD_TYPES; type++) {
+			memset(&x, 0, sizeof(x));
+			x.destId	= p->ids[i];
+			x.idSize	= id_size;
+			x.ftype		= ftype[type];
+			x.ttype		= ttype[type];
+			x.remoteAdr	= (type == LOAD_MAINT) ? LOAD_MAINT_OFS : p->remoteAdr;
+			x.localAdr	= (type == LOAD_NWRITE) ? BENCH_SRC_ADR : BENCH_CHK_ADR;
+			srio_xfer_class(&x, (type == LOAD_MAINT) ? SRIO_CLASS_CTRL : SRIO_CLASS_BULK);
+			x.outPort	= srio_port_next(x.destId);
+			srio_desc_build(&desc[i][type], &x);
+		}
+	}
+	for(nSizes=1; (p->sizeMin << (nSizes - 1)) < p->sizeMax; nSizes++)
+		;
+	mixSum = p->mix[LOAD_NWRITE] + p->mix[LOAD_NREAD] + p->mix[LOAD_MAINT];
+	period = p->rate ? TICKS_PER_SEC / p->rate : 0;
+
+	memset(win, 0, sizeof(win));
+	memset(&iv, 0, sizeof(iv));
+	memset(&tot, 0, sizeof(tot));
+	tStart = tIv = tNext = CSL_tscRead();
+	tEnd   = tStart + p->seconds * TICKS_PER_SEC;
+
+	while(1) {
+		cmd_idle();
+		for(i=0; i<LOAD_WINDOW && num; i++)
+			if(win[i].busy && load_complete(&win[i], &iv)) num--;
+
+		now = CSL_tscRead();
+		if(now < tEnd && num < p->window && (period == 0 || now >= tNext)) {
+			if(period) {
+				if(now - tNext > period) iv.late++;
+				tNext += period;					// now >= tNext here, tNext may pass now
+				if((int64_t)(now - tNext) > (int64_t)TICKS_PER_SEC) tNext = now;	// don't catch up a long stall
+			}
+			r = load_rand() % mixSum;
+			type = (r < p->mix[LOAD_NWRITE]) ? LOAD_NWRITE :
+				   (r < p->mix[LOAD_NWRITE] + p->mix[LOAD_NREAD]) ? LOAD_NREAD : LOAD_MAINT;
+			size = (type == LOAD_MAINT) ? 4 : p->sizeMin << (load_rand() % nSizes);
+			if(size > p->sizeMax) size = p->sizeMax;
+
+			for(slot=0; win[slot].busy; slot++)
+				;
+			const SrioDesc	*d = &desc[nextId][type];
+			cc = srio_desc_issue(srio_lsu_select((type == LOAD_MAINT) ? SRIO_CLASS_CTRL : SRIO_CLASS_BULK),
+								 d, d->xfer.remoteAdr, d->xfer.localAdr, size, &win[slot].op);
+			if(cc == SRIO_CC_OK) {
+				win[slot].type = type;
+				win[slot].busy = 1;
+				num++;
+			}
+			else
+				iv.errors[type]++;
+			if(++nextId == p->numIds) nextId = 0;
+		}
+
+		if(now - tIv >= p->interval * TICKS_PER_SEC || (now >= tEnd && num == 0)) {
+			sec = (uint32_t)((now - tStart) / TICKS_PER_SEC);
+			sprintf(name, "LOAD %5lu s", sec);
+			load_report(name, &iv, now - tIv);
+			load_add(&tot, &iv);
+			memset(&iv, 0, sizeof(iv));
+			con_drain(0);				// show the report now, not at the end of the run
+			tIv = CSL_tscRead();
+			if(now >= tEnd && num == 0) break;
+		}
+	}
+	load_report("LOAD total", &tot, now - tStart);
+
+	for(n=0, i=0; i<LOAD_TYPES; i++)
+		n += tot.errors[i];
+	return n ? -1 : 0;
+}
+
+/*********************** load_parse ********************
+* One "<key>=<value>" argument of the profile, -1 - bad argument
+****************************************************/
+static int	load_parse(LoadProfile *p, char *arg)
+{
+	char		*val = strchr(arg, '=');
+	char		*end;
+
+	if(val == NULL) return -1;
+	*val++ = 0;
+
+	if(strcmp(arg, "mix") == 0) {
+		p->mix[LOAD_NWRITE] = strtoul(val, &end, 10);
+		if(*end != '/') return -1;
+		p->mix[LOAD_NREAD] = strtoul(end + 1, &end, 10);
+		if(*end != '/') return -1;
+		p->mix[LOAD_MAINT] = strtoul(end + 1, &end, 10);
+	}
+	else if(strcmp(arg, "size") == 0) {
+		p->sizeMin = p->sizeMax = strtoul(val, &end, 10);
+		if(*end == '-') p->sizeMax = strtoul(end + 1, &end, 10);
+	}
+	else if(strcmp(arg, "rate") == 0)	p->rate		 = strtoul(val, &end, 10);
+	else if(strcmp(arg, "win") == 0)	p->window	 = strtoul(val, &end, 10);
+	else if(strcmp(arg, "time") == 0)	p->seconds	 = strtoul(val, &end, 10);
+	else if(strcmp(arg, "int") == 0)	p->interval	 = strtoul(val, &end, 10);
+	else if(strcmp(arg, "adr") == 0)	p->remoteAdr = strtoul(val, &end, 16);
+	else return -1;
+
+	return (*end == 0) ? 0 : -1;
+}
+
+///////////////////////////////////////////////////////////////
+////////// loadgenFunc() //////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int loadgenFunc(char *cmdStr)
+{
+	dbg_printf("LOADGEN: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i;
+	LoadProfile	p;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc < 1) {
+		printf("### loadgen: usage 'loadgen <IdList> [mix=W/R/M] [size=Min-Max] [rate=ReqPerSec]"
+			   " [win=N] [time=Sec] [int=Sec] [adr=RemAdrHex]'\n");
+		return -1;
+	}
+
+	memset(&p, 0, sizeof(p));
+	p.mix[LOAD_NWRITE] = 60;
+	p.mix[LOAD_NREAD]  = 30;
+	p.mix[LOAD_MAINT]  = 10;
+	p.sizeMin	= 256;
+	p.sizeMax	= 64*1024;
+	p.window	= LOAD_WINDOW / 2;
+	p.seconds	= 60;
+	p.interval	= 5;
+	p.remoteAdr	= BENCH_DST_ADR;
+
+	p.numIds = parse_id_list(args[0], p.ids, LOAD_ID_MAX);
+	if(p.numIds <= 0) {
+		printf("### loadgen: bad ID list '%s' (e.g. 1,4-7, max %d IDs)\n", args[0], LOAD_ID_MAX);
+		return -1;
+	}
+	for(i=1; i<argc; i++) {
+		if(load_parse(&p, args[i]) < 0) {
+			printf("### loadgen: bad argument '%s'\n", args[i]);
+			return -1;
+		}
+	}
+	if(p.mix[LOAD_NWRITE] + p.mix[LOAD_NREAD] + p.mix[LOAD_MAINT] == 0 ||
+	   p.sizeMin < 8 || p.sizeMax < p.sizeMin || p.sizeMax > BENCH_MAX_SIZE ||
+	   (p.sizeMin & (p.sizeMin - 1)) ||
+	   p.window == 0 || p.window > LOAD_WINDOW || p.seconds == 0 || p.interval == 0) {
+		printf("### loadgen: bad profile (size 8..%d, power of 2 min, win 1..%d, time/int > 0)\n",
+			BENCH_MAX_SIZE, LOAD_WINDOW);
+		return -1;
+	}
+	for(i=0; i<p.numIds; i++) {
+		if(id_size == SRIO_ID_8BIT && p.ids[i] > 0xFF) {
+			printf("### loadgen: ID 0x%X is too large for 8-bit ID size (see 'idsize')\n", p.ids[i]);
+			return -1;
+		}
+	}
+
+	printf("LOADGEN: %d IDs, mix W/R/M %lu/%lu/%lu, size %lu..%lu, rate %lu/s, win %lu, %lu s\n",
+		p.numIds, p.mix[LOAD_NWRITE], p.mix[LOAD_NREAD], p.mix[LOAD_MAINT],
+		p.sizeMin, p.sizeMax, p.rate, p.window, p.seconds);
+	return srio_load_run(&p);
+}
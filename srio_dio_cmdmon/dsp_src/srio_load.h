@@ -0,0 +1,54 @@
+/*
+ *  srio_load.h
+ *
+ *  Mixed traffic load generator of the SRIO Command Monitor.
+ */
+#ifndef SRIO_LOAD_H_
+#define SRIO_LOAD_H_
+
+#include <stdint.h>
+
+#define LOAD_ID_MAX				16		/* destinations of a profile */
+#define LOAD_WINDOW				16		/* max outstanding requests */
+#define LOAD_HIST_NUM			128		/* latency histogram: 4 buckets per octave */
+
+/* Request types of the profile mix */
+#define LOAD_NWRITE				0
+#define LOAD_NREAD				1
+#define LOAD_MAINT				2
+#define LOAD_TYPES				3
+
+/* Maintenance requests read the Device Identity CAR */
+#define LOAD_MAINT_OFS			0x0000
+
+/** Traffic profile */
+typedef struct
+{
+	uint16_t	ids[LOAD_ID_MAX];	/* destinations, used round robin */
+	int			numIds;
+	uint32_t	mix[LOAD_TYPES];	/* weights of NWRITE, NREAD, MAINT */
+	uint32_t	sizeMin;			/* NWRITE/NREAD sizes: powers of 2 in sizeMin..sizeMax */
+	uint32_t	sizeMax;
+	uint32_t	rate;				/* offered requests per second, 0 - as fast as possible */
+	uint32_t	window;				/* max outstanding requests (1..LOAD_WINDOW) */
+	uint32_t	seconds;			/* run time */
+	uint32_t	interval;			/* report interval (s) */
+	uint32_t	remoteAdr;			/* remote buffer of NWRITE/NREAD */
+} LoadProfile;
+
+/** Counters of a report interval or a whole run */
+typedef struct
+{
+	uint32_t	ops[LOAD_TYPES];	/* completed without error */
+	uint32_t	errors[LOAD_TYPES];
+	uint32_t	timeouts;			/* no completion in the policy timeout */
+	uint32_t	late;				/* requests issued behind the offered rate */
+	uint64_t	bytes;
+	uint32_t	latMax;				/* ticks */
+	uint32_t	hist[LOAD_HIST_NUM];
+} LoadStat;
+
+int		srio_load_run(const LoadProfile *p);
+int		loadgenFunc(char *cmdStr);
+
+#endif /* SRIO_LOAD_H_ */
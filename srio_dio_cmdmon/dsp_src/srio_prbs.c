@@ -0,0 +1,200 @@
+/*
+ *  srio_prbs.c
+ *
+ *  PRBS/counter traffic generator and data integrity checker.
+ *
+ *  The soak test fills the source buffer with a new pattern every
+ *  iteration, writes it to the peer (NWRITE), reads it back (NREAD) and
+ *  compares the read data with the source 64 bits at a time, counting
+ *  word and bit errors. Throughput and error counters are reported
+ *  every PRBS_REPORT_S seconds.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_prbs.h"
+
+/**
+ *  @b Description
+ *  @n
+ *      Fill the buffer with the pattern. PRBS31 is generated 16 bits
+ *      per step: with the last 31 bits in the state (newest in bit 0)
+ *      the next 16 bits are (s >> 15) ^ (s >> 12).
+ *
+ *  @retval
+ *      Pattern state after the buffer (seed of the next buffer)
+ */
+uint32_t	prbs_fill(uint32_t *buf, uint32_t words, int pattern, uint32_t seed)
+{
+	uint32_t	i, s, hi, lo;
+
+	if(pattern == PRBS_PAT_COUNTER) {
+		for(i=0; i<words; i++)
+			buf[i] = seed + i;
+		return seed + words;
+	}
+
+	s = seed & 0x7FFFFFFF;
+	if(s == 0) s = 1;
+	for(i=0; i<words; i++) {
+		hi = ((s >> 15) ^ (s >> 12)) & 0xFFFF;
+		s  = ((s << 16) | hi) & 0x7FFFFFFF;
+		lo = ((s >> 15) ^ (s >> 12)) & 0xFFFF;
+		s  = ((s << 16) | lo) & 0x7FFFFFFF;
+		buf[i] = (hi << 16) | lo;
+	}
+	return s;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Compare the buffer with the reference, 64 bits per step.
+ *      Buffers must be 8 bytes aligned and words must be even.
+ */
+void	prbs_check(const uint32_t *buf, const uint32_t *ref, uint32_t words, PrbsStat *st)
+{
+	uint32_t	i, xlo, xhi;
+	uint32_t	bits = 0, werr = 0;
+	long long	a, b;
+
+	_nassert((int)buf % 8 == 0);
+	_nassert((int)ref % 8 == 0);
+	#pragma MUST_ITERATE(1,,)
+	for(i=0; i<words/2; i++) {
+		a = _amem8((void *)&buf[2*i]);
+		b = _amem8((void *)&ref[2*i]);
+		xlo = _loll(a) ^ _loll(b);
+		xhi = _hill(a) ^ _hill(b);
+		bits += _dotpu4(_bitc4(xlo), 0x01010101) + _dotpu4(_bitc4(xhi), 0x01010101);
+		werr += (xlo != 0) + (xhi != 0);
+	}
+	st->words      += words;
+	st->bitErrors  += bits;
+	st->wordErrors += werr;
+}
+
+/*********************** prbs_report ********************
+****************************************************/
+static void	prbs_report(const PrbsStat *st, uint64_t ticks)
+{
+	uint32_t	s  = (uint32_t)(ticks / ((uint64_t)CPU_FREQ_MHZ * 1000000));
+	uint32_t	ms = (uint32_t)(ticks / ((uint64_t)CPU_FREQ_MHZ * 1000));
+	uint32_t	mbs = ms ? (uint32_t)(st->bytes / 1000 / ms) : 0;
+
+	printf("PRBS: %6lu s %8lu iter, %lu MB/s, %lu Mwords checked, %lu word errors, %lu bit errors, %lu xfer errors\n",
+		s, st->iterations, mbs, (uint32_t)(st->words / 1000000),
+		(uint32_t)st->wordErrors, (uint32_t)st->bitErrors, st->xferErrors);
+}
+
+///////////////////////////////////////////////////////////////
+////////// prbsFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int prbsFunc(char *cmdStr)
+{
+	dbg_printf("PRBS: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, cc;
+	char		*end;
+	SrioXfer	x;
+	PrbsStat	st;
+	uint32_t	size    = 0x10000;
+	uint32_t	seconds = 10;
+	int			pattern = PRBS_PAT_PRBS31;
+	uint32_t	remote  = PRBS_REMOTE_ADR;
+	uint32_t	*src = (uint32_t *)PRBS_SRC_ADR;
+	uint32_t	*chk = (uint32_t *)PRBS_CHK_ADR;
+	uint32_t	seed = 1;
+	uint64_t	t0, tEnd, tReport, now;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc < 1) {
+		printf("### prbs: destination ID expected\n");
+		return -1;
+	}
+	memset(&x, 0, sizeof(x));
+	x.destId = strtoul(args[0], &end, 16);
+	if(argc > 1) size    = strtoul(args[1], &end, 10);
+	if(argc > 2) seconds = strtoul(args[2], &end, 10);
+	if(argc > 3) {
+		if(strcmp(args[3], "cnt") == 0)			pattern = PRBS_PAT_COUNTER;
+		else if(strcmp(args[3], "prbs") != 0) {
+			printf("### prbs: bad pattern '%s' (prbs or cnt)\n", args[3]);
+			return -1;
+		}
+	}
+	if(argc > 4) remote = strtoul(args[4], &end, 16);
+	if(size < 8 || size > PRBS_MAX_SIZE || (size & 7) || seconds == 0) {
+		printf("### prbs: bad size %lu (8..%lu, multiple of 8) or time\n", size, (uint32_t)PRBS_MAX_SIZE);
+		return -1;
+	}
+	if(id_size == SRIO_ID_8BIT && x.destId > 0xFF) {
+		printf("### prbs: ID 0x%X is too large for 8-bit ID size (see 'idsize')\n", x.destId);
+		return -1;
+	}
+	x.idSize    = id_size;
+	x.remoteAdr = remote;
+	x.size      = size;
+	srio_xfer_class(&x, SRIO_CLASS_BULK);
+
+	printf("PRBS: ID 0x%X, %s pattern, %lu bytes at 0x%08lX, %lu s\n", x.destId,
+		pattern == PRBS_PAT_COUNTER ? "counter" : "PRBS31", size, remote, seconds);
+
+	memset(&st, 0, sizeof(st));
+	t0 = CSL_tscRead();
+	tEnd = t0 + (uint64_t)seconds * CPU_FREQ_MHZ * 1000000;
+	tReport = t0 + (uint64_t)PRBS_REPORT_S * CPU_FREQ_MHZ * 1000000;
+
+	do {
+		seed = prbs_fill(src, size/4, pattern, seed);
+		memset(chk, 0, size);
+		/* The LSU reads/writes the memory: write back src, no dirty chk lines
+		 * may be evicted over the NREAD data */
+		CACHE_wbL1d(src, size, CACHE_WAIT);
+		CACHE_wbInvL1d(chk, size, CACHE_WAIT);
+
+		x.ftype    = SRIO_FTYPE_NWRITE;
+		x.ttype    = SRIO_TTYPE_NWRITE;
+		x.localAdr = srio_global_adr((uint32_t)src);
+		cc = srio_xfer_stripe(&x, SRIO_CLASS_BULK, 0);
+		if(cc == SRIO_CC_OK) {
+			x.ftype    = SRIO_FTYPE_NREAD;
+			x.ttype    = SRIO_TTYPE_NREAD;
+			x.localAdr = srio_global_adr((uint32_t)chk);
+			cc = srio_xfer_stripe(&x, SRIO_CLASS_BULK, 0);
+		}
+		if(cc != SRIO_CC_OK) {
+			st.xferErrors++;
+			if(st.xferErrors <= 4)
+				printf("### PRBS: iteration %lu: %s\n", st.iterations, srio_cc_str(cc));
+			if(cc == SRIO_CC_LINK_DOWN) break;
+		} else {
+			CACHE_invL1d(chk, size, CACHE_WAIT);
+			prbs_check(chk, src, size/4, &st);
+			st.bytes += 2 * size;
+		}
+		st.iterations++;
+		cmd_idle();
+
+		now = CSL_tscRead();
+		if(now >= tReport) {
+			prbs_report(&st, now - t0);
+			tReport += (uint64_t)PRBS_REPORT_S * CPU_FREQ_MHZ * 1000000;
+		}
+	} while(now < tEnd);
+
+	prbs_report(&st, CSL_tscRead() - t0);
+	printf("PRBS: %s\n", (st.wordErrors || st.xferErrors) ? "FAILED" : "OK");
+	return (st.wordErrors || st.xferErrors) ? -1 : 0;
+}
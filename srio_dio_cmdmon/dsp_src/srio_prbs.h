@@ -0,0 +1,39 @@
+/*
+ *  srio_prbs.h
+ *
+ *  PRBS/counter traffic generator and data integrity checker.
+ */
+#ifndef SRIO_PRBS_H_
+#define SRIO_PRBS_H_
+
+#include <stdint.h>
+
+/* Default buffers (MSMC SRAM): local source and check buffers, remote buffer of peer */
+#define PRBS_SRC_ADR			0x0C000000
+#define PRBS_CHK_ADR			0x0C200000
+#define PRBS_REMOTE_ADR			0x0C100000
+#define PRBS_MAX_SIZE			0x100000
+
+/* Patterns */
+#define PRBS_PAT_PRBS31			0	/* x^31 + x^28 + 1 */
+#define PRBS_PAT_COUNTER		1	/* incrementing words */
+
+/* Report period (s) */
+#define PRBS_REPORT_S			1
+
+/** Soak test statistics */
+typedef struct
+{
+	uint64_t	bytes;			/* bytes written and read back */
+	uint64_t	words;			/* words checked */
+	uint64_t	wordErrors;		/* words with bit errors */
+	uint64_t	bitErrors;		/* bit errors */
+	uint32_t	iterations;
+	uint32_t	xferErrors;		/* failed transfers */
+} PrbsStat;
+
+uint32_t	prbs_fill(uint32_t *buf, uint32_t words, int pattern, uint32_t seed);
+void		prbs_check(const uint32_t *buf, const uint32_t *ref, uint32_t words, PrbsStat *st);
+int			prbsFunc(char *cmdStr);
+
+#endif /* SRIO_PRBS_H_ */
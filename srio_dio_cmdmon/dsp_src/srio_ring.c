@@ -0,0 +1,460 @@
+/*
+ *  srio_ring.c
+ *
+ *  Single producer / single consumer ring channel between two boards
+ *  over DirectIO.
+ *
+ *  Both boards keep the same layout at the ring base: the control block
+ *  (SrioRingCtrl) followed by RING_SLOTS slots of RING_SLOT_SIZE bytes.
+ *  The producer fills its own copy of a slot, then NWRITEs the filled
+ *  slots and the new tail into the consumer memory (optionally with a
+ *  doorbell). The consumer reads the slots in place and NWRITEs its head
+ *  back into the producer memory. Head and tail are free-running slot
+ *  counts; the ring is full when tail - head == RING_SLOTS.
+ *
+ *  Slots and the tail are sent through one LSU, one port and one
+ *  priority, so the tail can't pass the slot data.
+ *
+ *  Test slots carry the producer TSC in words 1..2; when the producer
+ *  is synchronized ('tsync') the consumer gets the one-way latency.
+ */
+#include <string.h>
+#include <stddef.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_ring.h"
+#include "srio_tsync.h"
+#include "srio_trace.h"
+
+SrioRing	srio_ring;
+
+#define RING_CTRL(base)		((SrioRingCtrl *)(base))
+#define RING_SLOT(base, n)	((base) + RING_SLOT_OFS + ((n) & (RING_SLOTS - 1)) * RING_SLOT_SIZE)
+
+/*********************** ring_xfer_init ********************
+* NWRITE from own ring memory to the same offset of the peer ring
+****************************************************/
+static void	ring_xfer_init(const SrioRing *r, SrioXfer *x, uint32_t ofs, uint32_t size)
+{
+	memset(x, 0, sizeof(*x));
+	x->destId	 = r->peerId;
+	x->idSize	 = id_size;
+	x->ftype	 = SRIO_FTYPE_NWRITE;
+	x->ttype	 = SRIO_TTYPE_NWRITE;
+	x->localAdr	 = srio_global_adr(r->localBase + ofs);
+	x->remoteAdr = r->remoteBase + ofs;
+	x->size		 = size;
+	srio_xfer_class(x, SRIO_CLASS_BULK);
+	x->outPort	 = r->outPort;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Open the ring channel to the peer and reset the own control block.
+ *
+ *  @param[in]  role
+ *      RING_ROLE_TX (producer) or RING_ROLE_RX (consumer)
+ *  @param[in]  localBase, remoteBase
+ *      Ring base in own and in peer memory
+ *
+ *  @retval
+ *      0 - Success, -1 - Error
+ */
+int	srio_ring_open(SrioRing *r, int role, uint16_t peerId, uint32_t localBase, uint32_t remoteBase)
+{
+	uint8_t		doorbell = r->doorbell;
+
+	if(role != RING_ROLE_TX && role != RING_ROLE_RX) return -1;
+	if((localBase & 7) || (remoteBase & 7)) return -1;
+
+	memset(r, 0, sizeof(*r));
+	r->role		  = role;
+	r->doorbell	  = doorbell;
+	r->peerId	  = peerId;
+	r->localBase  = localBase;
+	r->remoteBase = remoteBase;
+	r->outPort	  = srio_port_next(peerId);
+
+	RING_CTRL(localBase)->tail = 0;
+	RING_CTRL(localBase)->head = 0;
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Producer: get the next free slot. The peer head is picked up from
+ *      the own control block, where the consumer writes it.
+ *
+ *  @retval
+ *      Slot pointer, NULL if the ring is full
+ */
+uint32_t	*srio_ring_alloc(SrioRing *r)
+{
+	r->head = RING_CTRL(r->localBase)->head;
+	if(r->tail - r->head >= RING_SLOTS) {
+		r->stalls++;
+		return NULL;
+	}
+	return (uint32_t *)RING_SLOT(r->localBase, r->tail);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Producer: mark n allocated slots as filled. They are sent to the
+ *      consumer by the next srio_ring_flush().
+ */
+void	srio_ring_commit(SrioRing *r, uint32_t n)
+{
+	r->tail += n;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Producer: send the filled slots (at most two NWRITEs, as the range
+ *      may wrap) and then the tail to the consumer.
+ *
+ *  @retval
+ *      SRIO_CC_xxx
+ */
+int	srio_ring_flush(SrioRing *r)
+{
+	SrioXfer	x;
+	SrioOp		op[3];
+	uint32_t	first, n;
+	uint8_t		lsu;
+	int			num = 0, i, cc = SRIO_CC_OK, cc1;
+
+	if(r->role != RING_ROLE_TX || r->published == r->tail) return SRIO_CC_OK;
+
+	lsu = srio_lsu_select(SRIO_CLASS_BULK);
+	while(r->published != r->tail) {
+		first = r->published & (RING_SLOTS - 1);
+		n = r->tail - r->published;
+		if(n > RING_SLOTS - first) n = RING_SLOTS - first;
+		CACHE_wbL1d((void *)RING_SLOT(r->localBase, first), n * RING_SLOT_SIZE, CACHE_WAIT);
+		ring_xfer_init(r, &x, RING_SLOT_OFS + first * RING_SLOT_SIZE, n * RING_SLOT_SIZE);
+		cc = srio_xfer_issue(lsu, &x, &op[num]);
+		if(cc != SRIO_CC_OK) break;
+		num++;
+		r->published += n;
+	}
+
+	if(cc == SRIO_CC_OK) {
+		RING_CTRL(r->localBase)->tail = r->tail;
+		ring_xfer_init(r, &x, offsetof(SrioRingCtrl, tail), 4);
+		x.doorbell     = r->doorbell;
+		x.doorbellInfo = RING_DB_INFO;
+		cc = srio_xfer_issue(lsu, &x, &op[num]);
+		if(cc == SRIO_CC_OK) num++;
+	}
+
+	for(i=0; i<num; i++) {
+		cc1 = srio_xfer_wait(&op[i]);
+		if(cc == SRIO_CC_OK) cc = cc1;
+	}
+	if(cc != SRIO_CC_OK) {
+		r->published = RING_CTRL(r->localBase)->tail;	/* resend next time */
+		r->xferErrors++;
+		return cc;
+	}
+	r->flushes++;
+	return SRIO_CC_OK;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: get the oldest filled slot.
+ *
+ *  @retval
+ *      Slot pointer, NULL if the ring is empty
+ */
+uint32_t	*srio_ring_peek(SrioRing *r)
+{
+	uint32_t	*slot;
+
+	r->tail = RING_CTRL(r->localBase)->tail;
+	if(r->head == r->tail) return NULL;
+	slot = (uint32_t *)RING_SLOT(r->localBase, r->head);
+	CACHE_invL1d(slot, RING_SLOT_SIZE, CACHE_WAIT);
+	return slot;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: release n slots. The head is sent back to the producer
+ *      by srio_ring_publish().
+ */
+void	srio_ring_release(SrioRing *r, uint32_t n)
+{
+	r->head += n;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer: send the head to the producer.
+ *
+ *  @retval
+ *      SRIO_CC_xxx
+ */
+int	srio_ring_publish(SrioRing *r)
+{
+	SrioXfer	x;
+	int			cc;
+
+	if(r->role != RING_ROLE_RX || r->published == r->head) return SRIO_CC_OK;
+
+	RING_CTRL(r->localBase)->head = r->head;
+	ring_xfer_init(r, &x, offsetof(SrioRingCtrl, head), 4);
+	srio_xfer_class(&x, SRIO_CLASS_CTRL);
+	cc = srio_xfer(srio_lsu_select(SRIO_CLASS_CTRL), &x);
+	if(cc != SRIO_CC_OK) {
+		r->xferErrors++;
+		return cc;
+	}
+	r->published = r->head;
+	r->flushes++;
+	return SRIO_CC_OK;
+}
+
+/*********************** ring_drain ********************
+* Consumer: check and release all filled slots, then publish the head
+****************************************************/
+static uint32_t	ring_drain(SrioRing *r)
+{
+	uint32_t	*slot;
+	uint32_t	n = 0, lat;
+	uint64_t	now;
+	int64_t		offset;
+
+	while((slot = srio_ring_peek(r)) != NULL) {
+		if(slot[0] != r->seq || slot[RING_SLOT_SIZE/4 - 1] != ~r->seq) {
+			if(r->seqErrors++ < 4)
+				printf("### RING: slot %lu: seq 0x%08lX, expected 0x%08lX\n",
+					r->head, slot[0], r->seq);
+			r->seq = slot[0];
+		}
+		else {
+			now = CSL_tscRead();
+			if(srio_tsync_offset(r->peerId, now, &offset) == 0) {
+				lat = (uint32_t)((int64_t)now + offset - (int64_t)_itoll(slot[2], slot[1]));
+				if(r->latNum == 0 || lat < r->latMin) r->latMin = lat;
+				if(lat > r->latMax) r->latMax = lat;
+				r->latSum += lat;
+				r->latNum++;
+				srio_trace_rec(TRC_EV_RECV, 0, r->peerId, slot[0], RING_SLOT_SIZE,
+							   (SRIO_FTYPE_NWRITE << 4) | SRIO_TTYPE_NWRITE, 0, 0, lat);
+			}
+		}
+		r->seq++;
+		r->slots++;
+		srio_ring_release(r, 1);
+		n++;
+	}
+	if(n) srio_ring_publish(r);
+	return n;
+}
+
+/*********************** ring_doorbell ********************
+* Consumer: take the ring doorbell, 1 - it was pending
+****************************************************/
+static int	ring_doorbell(void)
+{
+	Uint16		pending;
+
+	CSL_SRIO_GetDoorbellPendingInterrupt (hSrio, RING_DB_REG, &pending);
+	if((pending & (1 << RING_DB_BIT)) == 0) return 0;
+	CSL_SRIO_ClearDoorbellPendingInterrupt (hSrio, RING_DB_REG, 1 << RING_DB_BIT);
+	return 1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Consumer side of the ring. Called periodically from the command
+ *      loop. With doorbells on, the slots are checked only after the
+ *      doorbell of the producer.
+ */
+void	srio_ring_poll(void)
+{
+	SrioRing	*r = &srio_ring;
+
+	if(r->role != RING_ROLE_RX) return;
+	if(r->doorbell && ring_doorbell() == 0) return;
+	ring_drain(r);
+}
+
+/*********************** ring_show ********************
+****************************************************/
+static void	ring_show(const SrioRing *r)
+{
+	if(r->role == RING_ROLE_NONE) {
+		printf("RING: closed, doorbell %s\n", r->doorbell ? "on" : "off");
+		return;
+	}
+	printf("RING: %s, peer 0x%X, local 0x%08lX, remote 0x%08lX, %d x %d bytes, doorbell %s\n",
+		r->role == RING_ROLE_TX ? "producer" : "consumer", r->peerId,
+		r->localBase, r->remoteBase, RING_SLOTS, RING_SLOT_SIZE, r->doorbell ? "on" : "off");
+	printf("  head %lu, tail %lu, published %lu\n", r->head, r->tail, r->published);
+	printf("  slots %lu, index updates %lu, stalls %lu, seq errors %lu, xfer errors %lu\n",
+		r->slots, r->flushes, r->stalls, r->seqErrors, r->xferErrors);
+	if(r->latNum)
+		printf("  one-way latency: min %lu ns, avg %lu ns, max %lu ns (%lu slots)\n",
+			r->latMin * 1000 / CPU_FREQ_MHZ, (uint32_t)(r->latSum * 1000 / CPU_FREQ_MHZ / r->latNum),
+			r->latMax * 1000 / CPU_FREQ_MHZ, r->latNum);
+}
+
+/*********************** ring_send ********************
+* Producer: send count slots, flushing every batch slots
+****************************************************/
+static int	ring_send(SrioRing *r, uint32_t count, uint32_t batch)
+{
+	uint32_t	*slot;
+	uint32_t	n, i;
+	uint64_t	t0, tWait, ticks, tsc;
+	int			cc = SRIO_CC_OK;
+
+	t0 = CSL_tscRead();
+	for(n=0; n<count && cc == SRIO_CC_OK; ) {
+		tWait = CSL_tscRead();
+		while((slot = srio_ring_alloc(r)) == NULL) {
+			if((cc = srio_ring_flush(r)) != SRIO_CC_OK) break;
+			cmd_idle();
+			if(CSL_tscRead() - tWait > (uint64_t)RING_WAIT_MS * CPU_FREQ_MHZ * 1000) {
+				printf("### RING: no free slot in %d ms (head %lu, tail %lu)\n",
+					RING_WAIT_MS, r->head, r->tail);
+				return -1;
+			}
+		}
+		if(slot == NULL) break;
+
+		slot[0] = r->seq;
+		for(i=3; i<RING_SLOT_SIZE/4 - 1; i++)
+			slot[i] = r->seq + i;
+		slot[RING_SLOT_SIZE/4 - 1] = ~r->seq;
+		r->seq++;
+		tsc = CSL_tscRead();
+		slot[1] = _loll(tsc);
+		slot[2] = _hill(tsc);
+		srio_ring_commit(r, 1);
+		n++;
+
+		if(r->tail - r->published >= batch || n == count)
+			cc = srio_ring_flush(r);
+	}
+	ticks = CSL_tscRead() - t0;
+	r->slots += n;
+
+	if(cc != SRIO_CC_OK) {
+		printf("### RING Error: %s after %lu slots\n", srio_cc_str(cc), n);
+		return -1;
+	}
+	printf("RING: %lu slots (%lu bytes) in %lu us, %lu MB/s\n", n, n * RING_SLOT_SIZE,
+		(uint32_t)(ticks / CPU_FREQ_MHZ),
+		ticks ? (uint32_t)(((uint64_t)n * RING_SLOT_SIZE * CPU_FREQ_MHZ) / ticks) : 0);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// ringFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int ringFunc(char *cmdStr)
+{
+	dbg_printf("RING: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, role;
+	char		*end;
+	SrioRing	*r = &srio_ring;
+	uint32_t	peerId, localBase = RING_BASE_ADR, remoteBase = RING_BASE_ADR;
+	uint32_t	count, batch, ms, n;
+	uint64_t	t0;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc == 0) {
+		ring_show(r);
+		return 0;
+	}
+
+	if(strcmp(args[0], "tx") == 0 || strcmp(args[0], "rx") == 0) {
+		if(argc < 2) {
+			printf("### ring: peer ID expected\n");
+			return -1;
+		}
+		role   = (args[0][0] == 't') ? RING_ROLE_TX : RING_ROLE_RX;
+		peerId = strtoul(args[1], &end, 16);
+		if(argc > 2) remoteBase = strtoul(args[2], &end, 16);
+		if(argc > 3) localBase  = strtoul(args[3], &end, 16);
+		if(id_size == SRIO_ID_8BIT && peerId > 0xFF) {
+			printf("### ring: ID 0x%lX is too large for 8-bit ID size (see 'idsize')\n", peerId);
+			return -1;
+		}
+		if(srio_ring_open(r, role, peerId, srio_global_adr(localBase), remoteBase) < 0) {
+			printf("### ring: ring base must be 8 bytes aligned\n");
+			return -1;
+		}
+		ring_show(r);
+		return 0;
+	}
+
+	if(strcmp(args[0], "close") == 0) {
+		r->role = RING_ROLE_NONE;
+		return 0;
+	}
+
+	if(strcmp(args[0], "db") == 0) {
+		if(argc > 1) r->doorbell = (strcmp(args[1], "on") == 0) ? 1 : 0;
+		printf("RING: doorbell %s\n", r->doorbell ? "on" : "off");
+		return 0;
+	}
+
+	if(strcmp(args[0], "send") == 0) {
+		if(r->role != RING_ROLE_TX) {
+			printf("### ring: not a producer (see 'ring tx')\n");
+			return -1;
+		}
+		count = (argc > 1) ? strtoul(args[1], &end, 10) : RING_SLOTS;
+		batch = (argc > 2) ? strtoul(args[2], &end, 10) : RING_SLOTS / 4;
+		if(batch == 0 || batch > RING_SLOTS) {
+			printf("### ring: bad batch %lu (1..%d)\n", batch, RING_SLOTS);
+			return -1;
+		}
+		return ring_send(r, count, batch);
+	}
+
+	if(strcmp(args[0], "recv") == 0) {
+		if(r->role != RING_ROLE_RX) {
+			printf("### ring: not a consumer (see 'ring rx')\n");
+			return -1;
+		}
+		ms = (argc > 1) ? strtoul(args[1], &end, 10) * 1000 : 10000;
+		n  = r->slots;
+		t0 = CSL_tscRead();
+		while(CSL_tscRead() - t0 < (uint64_t)ms * CPU_FREQ_MHZ * 1000) {
+			cmd_idle();
+			if(r->doorbell && ring_doorbell() == 0) continue;
+			ring_drain(r);
+		}
+		printf("RING: %lu slots received, %lu seq errors\n", r->slots - n, r->seqErrors);
+		return 0;
+	}
+
+	printf("### ring: bad arguments '%s'\n", cmdStr);
+	return -1;
+}
@@ -0,0 +1,75 @@
+/*
+ *  srio_ring.h
+ *
+ *  Single producer / single consumer ring channel between two boards
+ *  over DirectIO.
+ */
+#ifndef SRIO_RING_H_
+#define SRIO_RING_H_
+
+#include <stdint.h>
+
+/* Default ring base (global address of core 0 L2), same on both boards */
+#define RING_BASE_ADR			0x10870000
+#define RING_SLOTS				32			/* power of 2 */
+#define RING_SLOT_SIZE			1024		/* bytes, multiple of 8 */
+#define RING_SLOT_OFS			0x100		/* slots offset from ring base */
+
+/* Doorbell sent with the tail update: doorbell register 3, bit 0 */
+#define RING_DB_REG				3
+#define RING_DB_BIT				0
+#define RING_DB_INFO			((RING_DB_REG << 5) | RING_DB_BIT)
+
+/* Max wait for a free slot (ms) */
+#define RING_WAIT_MS			1000
+
+#define RING_ROLE_NONE			0
+#define RING_ROLE_TX			1			/* producer */
+#define RING_ROLE_RX			2			/* consumer */
+
+/** Ring control block at the ring base of both boards */
+typedef struct
+{
+	volatile uint32_t	tail;		/* producer -> consumer: slots written */
+	uint32_t			rsvd0[31];
+	volatile uint32_t	head;		/* consumer -> producer: slots released */
+	uint32_t			rsvd1[31];
+} SrioRingCtrl;
+
+/** Ring channel state */
+typedef struct
+{
+	uint8_t		role;			/* RING_ROLE_xxx */
+	uint8_t		doorbell;		/* 1 - doorbell with every tail update */
+	uint16_t	peerId;			/* device ID of the other board */
+	uint8_t		outPort;		/* all ring traffic uses one port */
+	uint32_t	localBase;		/* ring base in own memory */
+	uint32_t	remoteBase;		/* ring base in peer memory */
+	uint32_t	head;			/* slots released by consumer */
+	uint32_t	tail;			/* slots filled by producer */
+	uint32_t	published;		/* tail (TX) or head (RX) seen by the peer */
+	uint32_t	slots;			/* slots moved */
+	uint32_t	flushes;		/* index updates sent */
+	uint32_t	stalls;			/* producer found the ring full */
+	uint32_t	seqErrors;		/* consumer got an unexpected sequence number */
+	uint32_t	seq;			/* next sequence number */
+	uint32_t	xferErrors;
+	uint32_t	latNum;			/* slots with one-way latency (peer synchronized) */
+	uint32_t	latMin;			/* one-way latency, producer commit to consumer check (ticks) */
+	uint32_t	latMax;
+	uint64_t	latSum;
+} SrioRing;
+
+extern SrioRing	srio_ring;
+
+int			srio_ring_open(SrioRing *r, int role, uint16_t peerId, uint32_t localBase, uint32_t remoteBase);
+uint32_t	*srio_ring_alloc(SrioRing *r);
+void		srio_ring_commit(SrioRing *r, uint32_t n);
+int			srio_ring_flush(SrioRing *r);
+uint32_t	*srio_ring_peek(SrioRing *r);
+void		srio_ring_release(SrioRing *r, uint32_t n);
+int			srio_ring_publish(SrioRing *r);
+void		srio_ring_poll(void);
+int			ringFunc(char *cmdStr);
+
+#endif /* SRIO_RING_H_ */
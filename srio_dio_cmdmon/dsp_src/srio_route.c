@@ -0,0 +1,304 @@
+/*
+ *  srio_route.c
+ *
+ *  Per destination route and attribute table of the SRIO Command Monitor.
+ *
+ *  An entry holds hop count, output port, ID size, priority and preferred
+ *  write type of one destination ID. The fields that are set override the
+ *  values of every transfer to this ID (srio_route_apply() is called by
+ *  the transfer layer), so traffic to several targets needs no global
+ *  settings between the operations. Entries are set by 'route set' or by
+ *  'route disc'.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_route.h"
+
+SrioRoute	srio_route[SRIO_ROUTE_MAX];
+int			srio_route_num = 0;			/* valid entries */
+
+/**
+ *  @b Description
+ *  @n
+ *      Find the route of the destination.
+ *
+ *  @retval
+ *      Route entry, NULL if there is none
+ */
+SrioRoute	*srio_route_find(uint16_t destId)
+{
+	int		i;
+
+	if(srio_route_num == 0) return NULL;
+	for(i=0; i<SRIO_ROUTE_MAX; i++)
+		if(srio_route[i].valid && srio_route[i].destId == destId)
+			return &srio_route[i];
+	return NULL;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Get the route of the destination, adding an empty entry (all fields
+ *      SRIO_ROUTE_DEFAULT) if there is none.
+ *
+ *  @retval
+ *      Route entry, NULL if the table is full
+ */
+SrioRoute	*srio_route_add(uint16_t destId)
+{
+	SrioRoute	*r = srio_route_find(destId);
+	int			i;
+
+	if(r) return r;
+	for(i=0; i<SRIO_ROUTE_MAX; i++) {
+		if(srio_route[i].valid) continue;
+		r = &srio_route[i];
+		memset(r, SRIO_ROUTE_DEFAULT, sizeof(*r));
+		r->destId = destId;
+		r->valid  = 1;
+		srio_route_num++;
+		return r;
+	}
+	return NULL;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Check if the route of the destination prefers SWRITE for NWRITE.
+ *
+ *  @retval
+ *      1 - SWRITE is preferred, 0 - it is not
+ */
+int	srio_route_swrite(uint16_t destId)
+{
+	SrioRoute	*r = srio_route_find(destId);
+
+	return r != NULL && r->write == SRIO_ROUTE_WR_SWRITE;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Override the transfer fields by the route of its destination.
+ *      NWRITE becomes NWRITE_R or SWRITE if the route prefers it (SWRITE
+ *      only for 8 bytes aligned address and size).
+ */
+void	srio_route_apply(SrioXfer *x)
+{
+	SrioRoute	*r = srio_route_find(x->destId);
+
+	if(r == NULL) return;
+	if(r->hopCount != SRIO_ROUTE_DEFAULT)	x->hopCount = r->hopCount;
+	if(r->outPort  != SRIO_ROUTE_DEFAULT)	x->outPort  = r->outPort;
+	if(r->idSize   != SRIO_ROUTE_DEFAULT)	x->idSize   = r->idSize;
+	if(r->priority != SRIO_ROUTE_DEFAULT)	x->priority = r->priority;
+
+	if(x->ftype == SRIO_FTYPE_NWRITE && x->ttype == SRIO_TTYPE_NWRITE) {
+		if(r->write == SRIO_ROUTE_WR_NWRITE_R)
+			x->ttype = SRIO_TTYPE_NWRITE_R;
+		else if(r->write == SRIO_ROUTE_WR_SWRITE &&
+				((x->remoteAdr | x->localAdr | x->size) & 7) == 0) {
+			x->ftype = SRIO_FTYPE_SWRITE;
+			x->ttype = 0;
+		}
+	}
+}
+
+/*********************** route_show ********************
+****************************************************/
+static const char	*route_write_str(uint8_t write)
+{
+	switch(write) {
+	case SRIO_ROUTE_WR_NWRITE:		return "nw";
+	case SRIO_ROUTE_WR_NWRITE_R:	return "nwr";
+	case SRIO_ROUTE_WR_SWRITE:		return "sw";
+	}
+	return "-";
+}
+
+static void	route_field(uint8_t val)
+{
+	if(val == SRIO_ROUTE_DEFAULT)	printf("     -");
+	else							printf("%6d", val);
+}
+
+static void	route_show(void)
+{
+	int		i;
+
+	printf("ROUTE: %d of %d entries\n", srio_route_num, SRIO_ROUTE_MAX);
+	if(srio_route_num == 0) return;
+	printf("    ID   hop  port  idsz  prio  write\n");
+	for(i=0; i<SRIO_ROUTE_MAX; i++) {
+		const SrioRoute	*r = &srio_route[i];
+
+		if(r->valid == 0) continue;
+		printf("  %04X", r->destId);
+		route_field(r->hopCount);
+		route_field(r->outPort);
+		if(r->idSize == SRIO_ROUTE_DEFAULT)	printf("     -");
+		else								printf("%6d", r->idSize ? 16 : 8);
+		route_field(r->priority);
+		printf("  %s\n", route_write_str(r->write));
+	}
+}
+
+/*********************** route_probe ********************
+* Maintenance read of Base Device ID CSR of destId at hop count on port,
+* 1 - the reply is the destination itself
+****************************************************/
+static int	route_probe(uint16_t destId, uint8_t hop, uint8_t port, int idSize)
+{
+	static uint32_t	csr;
+	SrioXfer		x;
+	uint32_t		id;
+
+	memset(&x, 0, sizeof(x));
+	x.destId	= destId;
+	x.idSize	= idSize;
+	x.ftype		= SRIO_FTYPE_MAINT;
+	x.ttype		= SRIO_TTYPE_MAINT_RD;
+	x.hopCount	= hop;
+	x.remoteAdr	= SRIO_ROUTE_BASE_ID_CSR;
+	x.localAdr	= srio_global_adr((uint32_t)&csr);
+	x.size		= 4;
+	srio_xfer_class(&x, SRIO_CLASS_CTRL);
+	x.outPort	= port;
+
+	csr = 0xFFFFFFFF;
+	if(srio_xfer(srio_lsu_select(SRIO_CLASS_CTRL), &x) != SRIO_CC_OK)
+		return 0;
+	CACHE_invL1d(&csr, 4, CACHE_WAIT);
+	id = (idSize == SRIO_ID_16BIT) ? (csr & 0xFFFF) : ((csr >> 16) & 0xFF);
+	return id == destId;
+}
+
+/*********************** route_disc ********************
+* Find hop count and port of the destinations first..last
+****************************************************/
+static int	route_disc(uint16_t first, uint16_t last, uint8_t maxHop)
+{
+	SrioRoute	*r;
+	uint32_t	id;
+	uint8_t		mask, port, hop;
+	int			found = 0;
+
+	for(id=first; id<=last; id++) {
+		if(id == main_deviceID) continue;
+		if((r = srio_route_find(id)) != NULL) {		/* probe without the old route */
+			r->valid = 0;
+			srio_route_num--;
+		}
+		mask = srio_port_eligible(id);
+		for(hop=0; hop<=maxHop; hop++) {
+			for(port=0; port<4; port++)
+				if(((mask >> port) & 1) && route_probe(id, hop, port, id_size))
+					break;
+			if(port < 4) break;
+		}
+		if(hop > maxHop) continue;
+
+		if((r = srio_route_add(id)) == NULL) {
+			printf("### ROUTE: table is full\n");
+			break;
+		}
+		r->hopCount = hop;
+		r->outPort  = port;
+		r->idSize   = id_size;
+		printf("ROUTE: ID 0x%lX at hop %d, port %d\n", id, hop, port);
+		found++;
+	}
+	return found;
+}
+
+///////////////////////////////////////////////////////////////
+////////// routeFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int routeFunc(char *cmdStr)
+{
+	dbg_printf("ROUTE: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i;
+	char		*end;
+	uint32_t	id, last, val;
+	SrioRoute	*r;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc == 0) {
+		route_show();
+		return 0;
+	}
+
+	if(strcmp(args[0], "set") == 0 && argc >= 2) {
+		id = strtoul(args[1], &end, 16);
+		if((r = srio_route_add(id)) == NULL) {
+			printf("### route: table is full (%d entries)\n", SRIO_ROUTE_MAX);
+			return -1;
+		}
+		for(i=2; i+1<argc; i+=2) {
+			val = strtoul(args[i+1], &end, 10);
+			if(strcmp(args[i], "hop") == 0 && val < 256)				r->hopCount = val;
+			else if(strcmp(args[i], "port") == 0 && val < 4)			r->outPort  = val;
+			else if(strcmp(args[i], "idsize") == 0 && val == 8)			r->idSize   = SRIO_ID_8BIT;
+			else if(strcmp(args[i], "idsize") == 0 && val == 16)		r->idSize   = SRIO_ID_16BIT;
+			else if(strcmp(args[i], "prio") == 0 && val <= SRIO_PRIO_MAX)	r->priority = val;
+			else if(strcmp(args[i], "write") == 0 && strcmp(args[i+1], "nw") == 0)	r->write = SRIO_ROUTE_WR_NWRITE;
+			else if(strcmp(args[i], "write") == 0 && strcmp(args[i+1], "nwr") == 0)	r->write = SRIO_ROUTE_WR_NWRITE_R;
+			else if(strcmp(args[i], "write") == 0 && strcmp(args[i+1], "sw") == 0)	r->write = SRIO_ROUTE_WR_SWRITE;
+			else {
+				printf("### route: bad attribute '%s %s'\n", args[i], args[i+1]);
+				return -1;
+			}
+		}
+		if(i < argc) {
+			printf("### route: value of '%s' expected\n", args[i]);
+			return -1;
+		}
+		route_show();
+		return 0;
+	}
+
+	if(strcmp(args[0], "del") == 0 && argc >= 2) {
+		if(strcmp(args[1], "all") == 0) {
+			memset(srio_route, 0, sizeof(srio_route));
+			srio_route_num = 0;
+			return 0;
+		}
+		id = strtoul(args[1], &end, 16);
+		if((r = srio_route_find(id)) == NULL) {
+			printf("### route: no route to 0x%lX\n", id);
+			return -1;
+		}
+		r->valid = 0;
+		srio_route_num--;
+		return 0;
+	}
+
+	if(strcmp(args[0], "disc") == 0 && argc >= 3) {
+		id   = strtoul(args[1], &end, 16);
+		last = strtoul(args[2], &end, 16);
+		val  = (argc > 3) ? strtoul(args[3], &end, 10) : 0;
+		if(last < id || last > (id_size == SRIO_ID_16BIT ? 0xFFFF : 0xFF) || val > 255) {
+			printf("### route: bad ID range 0x%lX-0x%lX or hop %lu\n", id, last, val);
+			return -1;
+		}
+		printf("ROUTE: %d destinations found\n", route_disc(id, last, val));
+		return 0;
+	}
+
+	printf("### route: bad arguments '%s'\n", cmdStr);
+	return -1;
+}
@@ -0,0 +1,46 @@
+/*
+ *  srio_route.h
+ *
+ *  Per destination route and attribute table of the SRIO Command Monitor.
+ */
+#ifndef SRIO_ROUTE_H_
+#define SRIO_ROUTE_H_
+
+#include <stdint.h>
+#include "srio_xfer.h"
+
+#define SRIO_ROUTE_MAX			32
+
+/* Route field value: not set, the transfer keeps its own value */
+#define SRIO_ROUTE_DEFAULT		0xFF
+
+/* Preferred write type */
+#define SRIO_ROUTE_WR_NWRITE	0	/* NWRITE */
+#define SRIO_ROUTE_WR_NWRITE_R	1	/* NWRITE with response */
+#define SRIO_ROUTE_WR_SWRITE	2	/* SWRITE (8 bytes aligned transfers only) */
+
+/* Config offset of Base Device ID CSR, used by discovery */
+#define SRIO_ROUTE_BASE_ID_CSR	0x60
+
+/** Attributes of one destination */
+typedef struct
+{
+	uint16_t	destId;
+	uint8_t		valid;
+	uint8_t		hopCount;		/* maintenance hop count */
+	uint8_t		outPort;		/* output port */
+	uint8_t		idSize;			/* SRIO_ID_8BIT or SRIO_ID_16BIT */
+	uint8_t		priority;		/* request priority 0..SRIO_PRIO_MAX */
+	uint8_t		write;			/* SRIO_ROUTE_WR_xxx for NWRITE transfers */
+} SrioRoute;
+
+extern SrioRoute	srio_route[SRIO_ROUTE_MAX];
+extern int			srio_route_num;
+
+SrioRoute	*srio_route_find(uint16_t destId);
+SrioRoute	*srio_route_add(uint16_t destId);
+int			srio_route_swrite(uint16_t destId);
+void		srio_route_apply(SrioXfer *x);
+int			routeFunc(char *cmdStr);
+
+#endif /* SRIO_ROUTE_H_ */
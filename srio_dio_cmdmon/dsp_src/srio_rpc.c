@@ -0,0 +1,198 @@
+/*
+ *  srio_rpc.c
+ *
+ *  Remote command execution over an SRIO mailbox.
+ *
+ *  Every monitor has a mailbox (SrioRpcBox) at RPC_BASE_ADR. The caller
+ *  NWRITEs the command into the request of the target mailbox, then the
+ *  request number with a doorbell. The target runs the command through
+ *  the command table with the console output captured, and NWRITEs the
+ *  return code and the output back into the response of the caller
+ *  mailbox, again with the request number written last.
+ *
+ *  A board without a host console is started with -r: its command loop
+ *  only serves the mailbox.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_rpc.h"
+
+int			rpc_serve = 0;		// 1 - serve remote commands only (-r)
+
+static SrioRpcBox	*rpc_box = (SrioRpcBox *)RPC_BASE_ADR;
+static uint32_t		rpc_seq;		/* last own request */
+static uint32_t		rpc_done;		/* last request served */
+static uint32_t		rpc_served;
+
+/**
+ *  @b Description
+ *  @n
+ *      Reset the own mailbox.
+ */
+void	srio_rpc_init(void)
+{
+	memset(rpc_box, 0, sizeof(SrioRpcBox));
+	rpc_seq  = 0;
+	rpc_done = 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Run the command on the target monitor and wait for its response.
+ *
+ *  @param[in]  destId
+ *      Device ID of the target
+ *  @param[in]  cmd
+ *      Command line
+ *  @param[out]  resp
+ *      Response (return code and output)
+ *
+ *  @retval
+ *      SRIO_CC_xxx
+ */
+int	srio_rpc_call(uint16_t destId, const char *cmd, SrioRpcResp *resp)
+{
+	SrioRpcReq	*req = &rpc_box->reqOut;
+	uint64_t	t0;
+	int			cc;
+
+	memset(req, 0, sizeof(*req));
+	req->srcId	  = main_deviceID;
+	req->replyAdr = srio_global_adr((uint32_t)&rpc_box->resp);
+	strncpy(req->cmd, cmd, RPC_CMD_LEN - 1);
+	if((++rpc_seq & 0xFFFF) == 0) rpc_seq++;
+	req->seq	  = ((uint32_t)main_deviceID << 16) | (rpc_seq & 0xFFFF);	/* unique per caller */
+
+	cc = srio_xfer_post(destId, RPC_BASE_ADR + offsetof(SrioRpcBox, req), req,
+						offsetof(SrioRpcReq, seq), offsetof(SrioRpcReq, seq), RPC_DB_INFO);
+	if(cc != SRIO_CC_OK) return cc;
+
+	t0 = CSL_tscRead();
+	do {
+		CACHE_invL1d((void *)&rpc_box->resp.seq, 4, CACHE_WAIT);
+		if(rpc_box->resp.seq == req->seq) {
+			CACHE_invL1d(&rpc_box->resp, sizeof(SrioRpcResp), CACHE_WAIT);
+			memcpy(resp, &rpc_box->resp, sizeof(SrioRpcResp));
+			if(resp->len >= RPC_OUT_LEN) resp->len = RPC_OUT_LEN - 1;
+			resp->out[resp->len] = 0;
+			return SRIO_CC_OK;
+		}
+	} while(CSL_tscRead() - t0 < (uint64_t)RPC_WAIT_MS * CPU_FREQ_MHZ * 1000);
+
+	return SRIO_CC_SW_TIMEOUT;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Serve a new request of the own mailbox. Called periodically from
+ *      the command loop.
+ *
+ *  @retval
+ *      1 - request served, 0 - no request
+ */
+int	srio_rpc_poll(void)
+{
+	SrioRpcReq	*req = &rpc_box->req;
+	SrioRpcResp	*resp = &rpc_box->respOut;
+	char		cmd[RPC_CMD_LEN];
+	Uint16		pending;
+	uint16_t	srcId;
+	uint32_t	seq, replyAdr;
+	int			cc;
+
+	CSL_SRIO_GetDoorbellPendingInterrupt (hSrio, RPC_DB_REG, &pending);
+	if(pending & (1 << RPC_DB_BIT))
+		CSL_SRIO_ClearDoorbellPendingInterrupt (hSrio, RPC_DB_REG, 1 << RPC_DB_BIT);
+
+	CACHE_invL1d(req, sizeof(SrioRpcReq), CACHE_WAIT);
+	seq = req->seq;
+	if(seq == rpc_done) return 0;
+	rpc_done = seq;
+
+	/* the next caller may overwrite the mailbox while the command runs */
+	memcpy(cmd, req->cmd, RPC_CMD_LEN);
+	cmd[RPC_CMD_LEN - 1] = 0;
+	srcId	 = req->srcId;
+	replyAdr = req->replyAdr;
+	if(verbose_flag) printf("RPC: 0x%X: %s\n", srcId, cmd);
+
+	memset(resp, 0, offsetof(SrioRpcResp, out));
+	con_capture(resp->out, RPC_OUT_LEN);
+	resp->rc  = cmd_exec(cmd);
+	resp->len = con_capture_end();
+	resp->seq = seq;
+
+	/* only the used part of the output, then the sequence word */
+	cc = srio_xfer_post(srcId, replyAdr, resp, offsetof(SrioRpcResp, out) + ((resp->len + 4) & ~3),
+						offsetof(SrioRpcResp, seq), RPC_DB_INFO);
+	if(cc != SRIO_CC_OK)
+		printf("### RPC: response to 0x%X failed: %s\n", srcId, srio_cc_str(cc));
+	rpc_served++;
+	return 1;
+}
+
+///////////////////////////////////////////////////////////////
+////////// remoteFunc() ///////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int remoteFunc(char *cmdStr)
+{
+	dbg_printf("REMOTE: %s\n", cmdStr);
+
+	static SrioRpcResp	resp;
+	char		*end, *cmd;
+	uint32_t	destId, ms;
+	uint64_t	t0;
+	int			cc;
+
+	if(strncmp(cmdStr, "serve", 5) == 0) {
+		ms = strtoul(cmdStr + 5, &end, 10) * 1000;
+		if(ms == 0) ms = 10000;
+		printf("REMOTE: serving mailbox 0x%08lX for %lu s\n", (uint32_t)RPC_BASE_ADR, ms / 1000);
+		t0 = CSL_tscRead();
+		while(CSL_tscRead() - t0 < (uint64_t)ms * CPU_FREQ_MHZ * 1000) {
+			srio_rpc_poll();
+			cmd_idle();
+		}
+		printf("REMOTE: %lu requests served\n", rpc_served);
+		return 0;
+	}
+
+	destId = strtoul(cmdStr, &end, 16);
+	for(cmd = end; *cmd == ' ' || *cmd == '\t'; cmd++);
+	if(end == cmdStr || *cmd == 0) {
+		printf("### remote: usage 'remote <IdHex> <command>'\n");
+		return -1;
+	}
+	if(strlen(cmd) >= RPC_CMD_LEN) {
+		printf("### remote: command is longer than %d\n", RPC_CMD_LEN - 1);
+		return -1;
+	}
+	if(id_size == SRIO_ID_8BIT && destId > 0xFF) {
+		printf("### remote: ID 0x%lX is too large for 8-bit ID size (see 'idsize')\n", destId);
+		return -1;
+	}
+
+	cc = srio_rpc_call(destId, cmd, &resp);
+	if(cc != SRIO_CC_OK) {
+		printf("### REMOTE 0x%lX Error: %s\n", destId, srio_cc_str(cc));
+		return -1;
+	}
+	printf("%s", resp.out);
+	if(resp.len >= RPC_OUT_LEN - 1) printf("\n### REMOTE: output truncated\n");
+	printf("REMOTE 0x%lX: rc %ld\n", destId, resp.rc);
+	return resp.rc;
+}
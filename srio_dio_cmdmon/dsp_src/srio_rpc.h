@@ -0,0 +1,61 @@
+/*
+ *  srio_rpc.h
+ *
+ *  Remote command execution over an SRIO mailbox.
+ */
+#ifndef SRIO_RPC_H_
+#define SRIO_RPC_H_
+
+#include <stdint.h>
+
+/* Mailbox (global address of core 0 L2), same on all boards */
+#define RPC_BASE_ADR			0x1087C000
+#define RPC_CMD_LEN				240
+#define RPC_OUT_LEN				3072
+
+/* Doorbell sent with the request and the response: register 3, bit 1 */
+#define RPC_DB_REG				3
+#define RPC_DB_BIT				1
+#define RPC_DB_INFO				((RPC_DB_REG << 5) | RPC_DB_BIT)
+
+/* Max wait for the response (ms) */
+#define RPC_WAIT_MS				5000
+
+/** Request, the caller writes seq last */
+typedef struct
+{
+	uint16_t			srcId;		/* caller device ID */
+	uint16_t			rsvd;
+	uint32_t			replyAdr;	/* caller mailbox (global address) */
+	char				cmd[RPC_CMD_LEN];
+	uint32_t			rsvd1[3];
+	volatile uint32_t	seq;		/* request number */
+} SrioRpcReq;
+
+/** Response, the target writes seq last */
+typedef struct
+{
+	int32_t				rc;			/* return code of the command */
+	uint32_t			len;		/* bytes of output */
+	char				out[RPC_OUT_LEN];
+	uint32_t			rsvd[1];
+	volatile uint32_t	seq;		/* number of the request done */
+} SrioRpcResp;
+
+/** Mailbox of a monitor */
+typedef struct
+{
+	SrioRpcReq			req;		/* inbound request (written by the callers) */
+	SrioRpcReq			reqOut;		/* outbound request */
+	SrioRpcResp			resp;		/* response to own request (written by the target) */
+	SrioRpcResp			respOut;	/* outbound response */
+} SrioRpcBox;
+
+extern int	rpc_serve;
+
+void	srio_rpc_init(void);
+int		srio_rpc_call(uint16_t destId, const char *cmd, SrioRpcResp *resp);
+int		srio_rpc_poll(void);
+int		remoteFunc(char *cmdStr);
+
+#endif /* SRIO_RPC_H_ */
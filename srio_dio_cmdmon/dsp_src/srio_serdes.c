@@ -0,0 +1,294 @@
+/*
+ *  srio_serdes.c
+ *
+ *  SRIO SERDES equalization tuning of the SRIO Command Monitor.
+ *
+ *  'serdes tune' sweeps the SERDES settings of the lanes of one port:
+ *  first the receive equalizer with the current transmit setting, then
+ *  transmit swing and de-emphasis with the best equalizer. Every setting
+ *  runs NWRITE/NREAD test traffic to the given device through the port;
+ *  its score counts failed transfers, link drops and the port errors
+ *  (RIO_SP_ERR_RATE counter and RIO_SP_ERR_DET bits). The best setting is
+ *  applied and kept in srio_serdes_rx/tx[], which SrioDevice_init() uses
+ *  instead of the defaults of the speed.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_bootcfg.h>
+#include <ti/csl/csl_bootcfgAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_link.h"
+#include "srio_bench.h"
+#include "srio_serdes.h"
+
+extern void	SrioDevice_setSerdes(uint8_t laneMask, uint32_t rx, uint32_t tx);
+
+/* Swept values */
+static const uint8_t	tune_eq[]    = { 0x1, 0x0, 0x8, 0x9, 0xA, 0xB, 0xC, 0xD, 0xE, 0xF };
+static const uint8_t	tune_swing[] = { 0xF, 0xD, 0xB, 0x9 };
+static const uint8_t	tune_de[]    = { 0x0, 0x1, 0x2, 0x3, 0x5, 0x7, 0x9, 0xB };
+
+#define NUM(a)		(sizeof(a) / sizeof(a[0]))
+
+/**
+ *  @b Description
+ *  @n
+ *      Lanes of the port in the current lane mode.
+ *
+ *  @retval
+ *      Lane mask (bit n - lane n), 0 if the port is not used
+ */
+uint8_t	srio_serdes_lanes(uint8_t port)
+{
+	static const uint8_t	lanes[5][4] = {
+		{ 0x1, 0x2, 0x4, 0x8 },		/* four 1x */
+		{ 0x3, 0x0, 0x4, 0x8 },		/* 2x + 1x + 1x */
+		{ 0x1, 0x2, 0xC, 0x0 },		/* 1x + 1x + 2x */
+		{ 0x3, 0x0, 0xC, 0x0 },		/* two 2x */
+		{ 0xF, 0x0, 0x0, 0x0 }		/* one 4x */
+	};
+
+	if(lane_mode < 0 || lane_mode > 4 || port > 3) return 0;
+	return lanes[lane_mode][port];
+}
+
+/*********************** serdes_err_count ********************
+* Port errors since the last call (error rate counter and detected errors)
+****************************************************/
+static uint32_t	serdes_err_count(uint8_t port)
+{
+	uint32_t	n;
+
+	n  = hSrio->RIO_SP_ERR[port].RIO_SP_ERR_RATE & 0xFF;
+	n += _dotpu4(_bitc4(hSrio->RIO_SP_ERR[port].RIO_SP_ERR_DET), 0x01010101);
+	hSrio->RIO_SP_ERR[port].RIO_SP_ERR_RATE = hSrio->RIO_SP_ERR[port].RIO_SP_ERR_RATE & ~0xFF;
+	hSrio->RIO_SP_ERR[port].RIO_SP_ERR_DET  = 0;
+	hSrio->RIO_SP[port].RIO_SP_ERR_STAT     = SRIO_SP_ERR_STAT_W1C;
+	return n;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Apply the setting to the lanes of the port and score it by test
+ *      traffic (NWRITE and NREAD back) to destId for ms milliseconds.
+ *
+ *  @retval
+ *      Score (lower is better), SERDES_SCORE_FAIL if the port is not up
+ */
+uint32_t	srio_serdes_trial(uint8_t port, uint16_t destId, uint32_t rx, uint32_t tx, uint32_t ms)
+{
+	SrioXfer	x;
+	uint32_t	xferErr = 0, drops = 0;
+	uint64_t	t0, tEnd;
+
+	SrioDevice_setSerdes(srio_serdes_lanes(port), rx, tx);
+
+	/* wait for the port to train, then resync the ackIDs */
+	tEnd = CSL_tscRead() + (uint64_t)SERDES_LOCK_US * CPU_FREQ_MHZ;
+	while(!(hSrio->RIO_SP[port].RIO_SP_ERR_STAT & SRIO_SP_ERR_STAT_PORT_OK))
+		if(CSL_tscRead() > tEnd) return SERDES_SCORE_FAIL;
+	if(srio_link_ok(port) == 0 && srio_link_recover(port) < 0)
+		return SERDES_SCORE_FAIL;
+	serdes_err_count(port);
+
+	memset(&x, 0, sizeof(x));
+	x.destId	= destId;
+	x.idSize	= id_size;
+	x.size		= SERDES_TUNE_SIZE;
+	x.outPort	= port;
+	srio_xfer_class(&x, SRIO_CLASS_BULK);
+
+	t0 = CSL_tscRead();
+	tEnd = t0 + (uint64_t)ms * CPU_FREQ_MHZ * 1000;
+	while(CSL_tscRead() < tEnd) {
+		x.ftype		= SRIO_FTYPE_NWRITE;
+		x.ttype		= SRIO_TTYPE_NWRITE;
+		x.localAdr	= BENCH_SRC_ADR;
+		x.remoteAdr	= BENCH_DST_ADR;
+		if(srio_xfer(srio_lsu_select(SRIO_CLASS_BULK), &x) != SRIO_CC_OK) xferErr++;
+
+		x.ftype		= SRIO_FTYPE_NREAD;
+		x.ttype		= SRIO_TTYPE_NREAD;
+		x.localAdr	= BENCH_CHK_ADR;
+		if(srio_xfer(srio_lsu_select(SRIO_CLASS_BULK), &x) != SRIO_CC_OK) xferErr++;
+
+		if(srio_link_ok(port) == 0) {
+			drops++;
+			if(srio_link_recover(port) < 0) return SERDES_SCORE_FAIL;
+		}
+	}
+
+	return drops * 10000 + xferErr * 100 + serdes_err_count(port);
+}
+
+/*********************** serdes_lane_tx ********************
+* TX setting of the lane with its own MSYNC bit (lane sync master of the port)
+****************************************************/
+static uint32_t	serdes_lane_tx(int lane, uint32_t tx)
+{
+	uint32_t	cfg;
+
+	CSL_BootCfgGetSRIOSERDESTxConfig (lane, &cfg);
+	return (tx & ~SERDES_TX_MSYNC) | (cfg & SERDES_TX_MSYNC);
+}
+
+/*********************** serdes_show ********************
+****************************************************/
+static void	serdes_show(void)
+{
+	Uint16		pll;
+	uint32_t	rx, tx;
+	int			i;
+
+	CSL_BootCfgGetSRIOSERDESConfigPLL (&pll);
+	printf("SERDES: PLL 0x%03X\n", pll);
+	for(i=0; i<4; i++) {
+		CSL_BootCfgGetSRIOSERDESRxConfig (i, &rx);
+		CSL_BootCfgGetSRIOSERDESTxConfig (i, &tx);
+		printf("  lane %d: RX 0x%08lX (EQ %lX)  TX 0x%08lX (SWING %lX, DE %lX)%s\n", i,
+			rx, SERDES_FIELD(rx, SERDES_RX_EQ), tx, SERDES_FIELD(tx, SERDES_TX_SWING),
+			SERDES_FIELD(tx, SERDES_TX_DE), srio_serdes_rx[i] ? "  tuned" : "");
+	}
+}
+
+/*********************** serdes_save ********************
+* Write 'serdes set' commands of the tuned lanes to host file
+****************************************************/
+static int	serdes_save(const char *name)
+{
+	FILE	*fp;
+	int		i;
+
+	fp = fopen(name, "w");
+	if(fp == NULL) {
+		printf("### serdes: can't open file '%s'\n", name);
+		return -1;
+	}
+	for(i=0; i<4; i++)
+		if(srio_serdes_rx[i])
+			fprintf(fp, "serdes set %d %08lX %08lX\n", i, srio_serdes_rx[i], srio_serdes_tx[i]);
+	fclose(fp);
+	return 0;
+}
+
+/*********************** serdes_tune ********************
+****************************************************/
+static int	serdes_tune(uint8_t port, uint16_t destId, uint32_t ms)
+{
+	uint8_t		lanes = srio_serdes_lanes(port);
+	uint32_t	rx, tx, rx0, tx0, bestRx, bestTx, best, score;
+	int			lane, i, j;
+
+	for(lane=0; ((lanes >> lane) & 1) == 0; lane++);
+	CSL_BootCfgGetSRIOSERDESRxConfig (lane, &rx0);
+	CSL_BootCfgGetSRIOSERDESTxConfig (lane, &tx0);
+
+	printf("SERDES: tuning port %d (lanes 0x%X) with ID 0x%X, %lu ms per setting\n",
+		port, lanes, destId, ms);
+
+	/* current setting first, it wins the ties */
+	bestRx = rx0;
+	bestTx = tx0;
+	best = srio_serdes_trial(port, destId, rx0, tx0, ms);
+	printf("  current  RX 0x%08lX TX 0x%08lX: score %ld\n", rx0, tx0, (int32_t)best);
+
+	/* receive equalizer */
+	for(i=0; i<NUM(tune_eq) && best; i++) {
+		rx = SERDES_SET(rx0, SERDES_RX_EQ, tune_eq[i]);
+		if(rx == rx0) continue;
+		score = srio_serdes_trial(port, destId, rx, bestTx, ms);
+		if(verbose_flag) printf("  EQ %X: score %ld\n", tune_eq[i], (int32_t)score);
+		if(score < best) { best = score; bestRx = rx; }
+	}
+
+	/* transmit swing and de-emphasis */
+	for(i=0; i<NUM(tune_swing) && best; i++) {
+		for(j=0; j<NUM(tune_de) && best; j++) {
+			tx = SERDES_SET(SERDES_SET(tx0, SERDES_TX_SWING, tune_swing[i]), SERDES_TX_DE, tune_de[j]);
+			if(tx == tx0) continue;
+			score = srio_serdes_trial(port, destId, bestRx, tx, ms);
+			if(verbose_flag) printf("  SWING %X DE %X: score %ld\n", tune_swing[i], tune_de[j], (int32_t)score);
+			if(score < best) { best = score; bestTx = tx; }
+		}
+	}
+
+	/* apply and keep the best one */
+	srio_serdes_trial(port, destId, bestRx, bestTx, 1);
+	for(lane=0; lane<4; lane++) {
+		if(((lanes >> lane) & 1) == 0) continue;
+		srio_serdes_rx[lane] = bestRx;
+		srio_serdes_tx[lane] = serdes_lane_tx(lane, bestTx);
+	}
+
+	if(best == SERDES_SCORE_FAIL) {
+		printf("### SERDES: port %d doesn't come up with any setting\n", port);
+		return -1;
+	}
+	printf("SERDES: best RX 0x%08lX (EQ %lX) TX 0x%08lX (SWING %lX, DE %lX): score %lu\n",
+		bestRx, SERDES_FIELD(bestRx, SERDES_RX_EQ), bestTx, SERDES_FIELD(bestTx, SERDES_TX_SWING),
+		SERDES_FIELD(bestTx, SERDES_TX_DE), best);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// serdesFunc() ///////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int serdesFunc(char *cmdStr)
+{
+	dbg_printf("SERDES: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, lane;
+	char		*end;
+	uint32_t	port, destId, ms, rx, tx;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc == 0) {
+		serdes_show();
+		return 0;
+	}
+
+	if(strcmp(args[0], "tune") == 0 && argc >= 3) {
+		port   = strtoul(args[1], &end, 10);
+		destId = strtoul(args[2], &end, 16);
+		ms     = (argc > 3) ? strtoul(args[3], &end, 10) : SERDES_TUNE_MS;
+		if(port > 3 || srio_serdes_lanes(port) == 0 || ms == 0) {
+			printf("### serdes: port %lu is not used in lane mode %d (see 'ports') or bad time\n", port, lane_mode);
+			return -1;
+		}
+		if(id_size == SRIO_ID_8BIT && destId > 0xFF) {
+			printf("### serdes: ID 0x%lX is too large for 8-bit ID size (see 'idsize')\n", destId);
+			return -1;
+		}
+		return serdes_tune(port, destId, ms);
+	}
+
+	if(strcmp(args[0], "set") == 0 && argc >= 4) {
+		rx = strtoul(args[2], &end, 16);
+		tx = strtoul(args[3], &end, 16);
+		for(lane=0; lane<4; lane++) {
+			if(strcmp(args[1], "all") != 0 && lane != atoi(args[1])) continue;
+			SrioDevice_setSerdes(1 << lane, rx, tx);
+			srio_serdes_rx[lane] = rx;
+			srio_serdes_tx[lane] = serdes_lane_tx(lane, tx);
+		}
+		serdes_show();
+		return 0;
+	}
+
+	if(strcmp(args[0], "save") == 0 && argc >= 2)
+		return serdes_save(args[1]);
+
+	printf("### serdes: bad arguments '%s'\n", cmdStr);
+	return -1;
+}
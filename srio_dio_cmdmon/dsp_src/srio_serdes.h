@@ -0,0 +1,38 @@
+/*
+ *  srio_serdes.h
+ *
+ *  SRIO SERDES equalization tuning of the SRIO Command Monitor.
+ */
+#ifndef SRIO_SERDES_H_
+#define SRIO_SERDES_H_
+
+#include <stdint.h>
+
+/* SRIO SERDES CFGRXn / CFGTXn fields swept by 'serdes tune' */
+#define SERDES_RX_EQ_MASK		0x003C0000	/* CFGRX EQ bits 21:18 */
+#define SERDES_RX_EQ_SHIFT		18
+#define SERDES_TX_SWING_MASK	0x00000780	/* CFGTX SWING bits 10:7 */
+#define SERDES_TX_SWING_SHIFT	7
+#define SERDES_TX_DE_MASK		0x0007C000	/* CFGTX TWPST1 (de-emphasis) bits 18:14 */
+#define SERDES_TX_DE_SHIFT		14
+#define SERDES_TX_MSYNC			0x00100000	/* CFGTX MSYNC bit 20, own of every lane */
+
+#define SERDES_FIELD(cfg, f)	(((cfg) & f##_MASK) >> f##_SHIFT)
+#define SERDES_SET(cfg, f, v)	(((cfg) & ~f##_MASK) | (((v) << f##_SHIFT) & f##_MASK))
+
+/* Test traffic of one setting */
+#define SERDES_TUNE_MS			200			/* default time */
+#define SERDES_TUNE_SIZE		(16*1024)	/* bytes per NWRITE/NREAD */
+#define SERDES_LOCK_US			20000		/* port OK after new setting */
+
+/* Score of a setting that doesn't bring the port up */
+#define SERDES_SCORE_FAIL		0xFFFFFFFF
+
+extern uint32_t	srio_serdes_rx[4];
+extern uint32_t	srio_serdes_tx[4];
+
+uint8_t		srio_serdes_lanes(uint8_t port);
+uint32_t	srio_serdes_trial(uint8_t port, uint16_t destId, uint32_t rx, uint32_t tx, uint32_t ms);
+int			serdesFunc(char *cmdStr);
+
+#endif /* SRIO_SERDES_H_ */
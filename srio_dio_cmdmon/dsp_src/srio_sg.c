@@ -0,0 +1,236 @@
+/*
+ *  srio_sg.c
+ *
+ *  Scatter/gather descriptor lists of the DirectIO path.
+ *
+ *  A chain of (local address, destination, remote address, length, type)
+ *  descriptors is executed back-to-back on the LSUs of the class with up to
+ *  SRIO_STRIPE_WINDOW requests in progress, and completes once for the
+ *  whole chain. Each descriptor gets a precomputed LSU descriptor
+ *  (srio_desc_build()) before the run.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_sg.h"
+
+static SrioSgDesc	sg_chain[SRIO_SG_MAX_DESC];
+static SrioDesc		sg_desc[SRIO_SG_MAX_DESC];
+static int			sg_num = 0;
+
+/** Request in progress with its descriptor */
+typedef struct
+{
+	SrioOp		op;
+	int			desc;
+} SgOp;
+
+/*********************** sg_collect ********************
+* Wait for the oldest request in progress
+****************************************************/
+static void	sg_collect(SgOp *ops, int *first, int *num, SrioSgResult *res)
+{
+	SgOp	*o = &ops[*first];
+	int		cc;
+
+	cc = srio_xfer_wait(&o->op);
+	if(cc == SRIO_CC_OK)
+		res->bytes += o->op.xfer.size;
+	else if(res->cc == SRIO_CC_OK) {
+		res->cc     = cc;
+		res->failed = o->desc;
+	}
+	*first = (*first + 1) % SRIO_STRIPE_WINDOW;
+	(*num)--;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Build the LSU descriptor (see srio_desc_build()) of every chain
+ *      descriptor: destination, route, output port, class and type.
+ *
+ *  @param[out] desc
+ *      num LSU descriptors.
+ */
+void	srio_sg_build(const SrioSgDesc *list, int num, int cls, SrioDesc *desc)
+{
+	SrioXfer	x;
+	int			i;
+
+	for(i=0; i<num; i++) {
+		const SrioSgDesc	*d = &list[i];
+
+		memset(&x, 0, sizeof(x));
+		x.idSize  = id_size;
+		srio_xfer_class(&x, cls);
+		x.destId  = d->destId;
+		x.outPort = srio_port_next(d->destId);
+		x.ftype   = (d->type == SRIO_SG_READ) ? SRIO_FTYPE_NREAD : SRIO_FTYPE_NWRITE;
+		x.ttype   = (d->type == SRIO_SG_READ) ? SRIO_TTYPE_NREAD :
+					(d->type == SRIO_SG_WRITE_R) ? SRIO_TTYPE_NWRITE_R : SRIO_TTYPE_NWRITE;
+		srio_desc_build(&desc[i], &x);
+	}
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Execute the descriptor chain. The descriptors longer than the LSU
+ *      byte count limit are split. The LSU descriptors are built before
+ *      by srio_sg_build(), so the per-request work is only the address
+ *      and size stores of srio_desc_issue().
+ *
+ *  @param[in]  list
+ *      Descriptors.
+ *  @param[in]  desc
+ *      LSU descriptors of the list.
+ *  @param[in]  num
+ *      Number of descriptors.
+ *  @param[in]  cls
+ *      Priority class, selects the LSUs used.
+ *  @param[out] res
+ *      Completion of the chain.
+ *
+ *  @retval
+ *      SRIO_CC_OK or the first error code
+ */
+int	srio_sg_run(const SrioSgDesc *list, const SrioDesc *desc, int num, int cls, SrioSgResult *res)
+{
+	SgOp		ops[SRIO_STRIPE_WINDOW];
+	int			first = 0, busy = 0, i, cc;
+	uint32_t	done, size;
+
+	memset(res, 0, sizeof(*res));
+	res->failed = -1;
+
+	for(i=0; i<num && res->cc == SRIO_CC_OK; i++) {
+		const SrioSgDesc	*d = &list[i];
+
+		for(done=0; done < d->len; done += size) {
+			if(busy == SRIO_STRIPE_WINDOW)
+				sg_collect(ops, &first, &busy, res);
+			if(res->cc != SRIO_CC_OK) break;
+
+			size = (d->len - done < SRIO_LSU_MAX_BYTES) ? d->len - done : SRIO_LSU_MAX_BYTES;
+
+			SgOp	*o = &ops[(first + busy) % SRIO_STRIPE_WINDOW];
+			cc = srio_desc_issue(srio_lsu_select(cls), &desc[i], d->remoteAdr + done, d->localAdr + done,
+								 size, &o->op);
+			if(cc != SRIO_CC_OK) {
+				res->cc     = cc;
+				res->failed = i;
+				break;
+			}
+			o->desc = i;
+			busy++;
+			res->requests++;
+		}
+	}
+
+	while(busy)
+		sg_collect(ops, &first, &busy, res);
+
+	return res->cc;
+}
+
+///////////////////////////////////////////////////////////////
+////////// sgFunc() ///////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int sgFunc(char *cmdStr)
+{
+	dbg_printf("SG: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i;
+	char		*end;
+	SrioSgDesc	*d;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+
+	if(argc >= 5 && strcmp(args[0], "add") == 0) {
+		if(sg_num == SRIO_SG_MAX_DESC) {
+			printf("### sg: chain is full (%d descriptors)\n", SRIO_SG_MAX_DESC);
+			return -1;
+		}
+		d = &sg_chain[sg_num];
+		d->destId    = strtoul(args[1], &end, 16);
+		d->remoteAdr = strtoul(args[2], &end, 16);
+		d->localAdr  = srio_global_adr(strtoul(args[3], &end, 16));
+		d->len       = strtoul(args[4], &end, 10);
+		d->type      = SRIO_SG_WRITE;
+		if(argc > 5) {
+			if(strcmp(args[5], "r") == 0)			d->type = SRIO_SG_READ;
+			else if(strcmp(args[5], "wr") == 0)	d->type = SRIO_SG_WRITE_R;
+			else if(strcmp(args[5], "w") != 0) {
+				printf("### sg: bad type '%s' (w, wr or r)\n", args[5]);
+				return -1;
+			}
+		}
+		if(d->len == 0 || (id_size == SRIO_ID_8BIT && d->destId > 0xFF)) {
+			printf("### sg: bad length or ID\n");
+			return -1;
+		}
+		if(d->remoteAdr + d->len - 1 < d->remoteAdr) {
+			printf("### sg: bad length %lu (descriptor can't cross 4 GB boundary)\n", d->len);
+			return -1;
+		}
+		sg_num++;
+	}
+	else if(argc == 1 && strcmp(args[0], "clr") == 0) {
+		sg_num = 0;
+	}
+	else if(argc >= 1 && strcmp(args[0], "run") == 0) {
+		SrioSgResult	res;
+		uint32_t		count = (argc > 1) ? strtoul(args[1], &end, 10) : 1;
+		uint32_t		n, bytes = 0, reqs = 0, us;
+		uint64_t		t0;
+
+		if(sg_num == 0) {
+			printf("### sg: chain is empty\n");
+			return -1;
+		}
+		if(count == 0) {
+			printf("### sg: bad run count 0\n");
+			return -1;
+		}
+		srio_sg_build(sg_chain, sg_num, xfer_class, sg_desc);
+		t0 = CSL_tscRead();
+		for(n=0; n<count; n++) {
+			if(srio_sg_run(sg_chain, sg_desc, sg_num, xfer_class, &res) != SRIO_CC_OK) break;
+			bytes += res.bytes;
+			reqs  += res.requests;
+		}
+		us = (uint32_t)((CSL_tscRead() - t0) / CPU_FREQ_MHZ);
+
+		if(res.cc != SRIO_CC_OK) {
+			printf("### SG Error: %s on descriptor %d of run %lu\n", srio_cc_str(res.cc), res.failed, n);
+			return -1;
+		}
+		printf("SG: %lu runs of %d descriptors, %lu requests, %lu bytes in %lu us (%lu MB/s, %lu ns/request)\n",
+			count, sg_num, reqs, bytes, us, us ? bytes / us : 0, reqs ? (us * 1000) / reqs : 0);
+		return 0;
+	}
+	else if(argc != 0) {
+		printf("### sg: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	printf("SG: %d descriptors\n", sg_num);
+	for(i=0; i<sg_num; i++) {
+		d = &sg_chain[i];
+		printf("%3d: %-2s ID 0x%02X  remote 0x%08lX  local 0x%08lX  %lu bytes\n", i,
+			d->type == SRIO_SG_READ ? "r" : (d->type == SRIO_SG_WRITE_R ? "wr" : "w"),
+			d->destId, d->remoteAdr, d->localAdr, d->len);
+	}
+	return 0;
+}
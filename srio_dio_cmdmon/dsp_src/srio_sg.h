@@ -0,0 +1,43 @@
+/*
+ *  srio_sg.h
+ *
+ *  Scatter/gather descriptor lists of the DirectIO path.
+ */
+#ifndef SRIO_SG_H_
+#define SRIO_SG_H_
+
+#include <stdint.h>
+#include "srio_xfer.h"
+
+/* Max descriptors in the chain of 'sg' command */
+#define SRIO_SG_MAX_DESC		64
+
+/* Descriptor types */
+#define SRIO_SG_WRITE			0	/* NWRITE local -> remote */
+#define SRIO_SG_READ			1	/* NREAD remote -> local */
+#define SRIO_SG_WRITE_R			2	/* NWRITE_R local -> remote, with response */
+
+/** Scatter/gather descriptor */
+typedef struct
+{
+	uint32_t	localAdr;		/* DSP (global) address */
+	uint32_t	remoteAdr;		/* RapidIO address (32-bit) */
+	uint32_t	len;			/* byte count, any size */
+	uint16_t	destId;			/* destination device ID */
+	uint8_t		type;			/* SRIO_SG_xxx */
+} SrioSgDesc;
+
+/** Completion of the chain */
+typedef struct
+{
+	int			cc;				/* SRIO_CC_OK or first error code */
+	int			failed;			/* index of failed descriptor (-1 - none) */
+	uint32_t	requests;		/* LSU requests issued */
+	uint32_t	bytes;			/* bytes completed */
+} SrioSgResult;
+
+void	srio_sg_build(const SrioSgDesc *list, int num, int cls, SrioDesc *desc);
+int		srio_sg_run(const SrioSgDesc *list, const SrioDesc *desc, int num, int cls, SrioSgResult *res);
+int		sgFunc(char *cmdStr);
+
+#endif /* SRIO_SG_H_ */
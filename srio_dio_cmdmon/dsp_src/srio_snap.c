@@ -0,0 +1,363 @@
+/*
+ *  srio_snap.c
+ *
+ *  Snapshot and diff of the SRIO and SERDES registers.
+ *
+ *  'snap' captures the whole SRIO MMR space and the BootCfg SERDES
+ *  registers into a memory slot in one pass, or the RapidIO configuration
+ *  space of a remote device by pipelined maintenance reads. 'snapdiff'
+ *  compares two slots and prints the changed registers by name.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_bootcfg.h>
+#include <ti/csl/csl_bootcfgAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_snap.h"
+
+#define SNAP_SRIO_WORDS		(sizeof(CSL_SrioRegs)/4)
+#define SNAP_OFS(field)		((uint32_t)offsetof(CSL_SrioRegs, field))
+
+/* Offset of the RapidIO configuration space (CAR/CSR) in SRIO MMR */
+#define SNAP_CFG_OFS		SNAP_OFS(RIO_DEV_ID)
+
+/* Register name table */
+typedef struct
+{
+	const char	*name;
+	uint32_t	ofs;
+} SnapReg;
+
+#define SNAP_REG(field)			{ #field, SNAP_OFS(field) }
+#define SNAP_SP(n)				SNAP_REG(RIO_SP[n].RIO_SP_LM_REQ),				\
+								SNAP_REG(RIO_SP[n].RIO_SP_ACKID_STAT),			\
+								SNAP_REG(RIO_SP[n].RIO_SP_CTL2),				\
+								SNAP_REG(RIO_SP[n].RIO_SP_ERR_STAT),			\
+								SNAP_REG(RIO_SP[n].RIO_SP_CTL),					\
+								SNAP_REG(RIO_SP_ERR[n].RIO_SP_ERR_DET),			\
+								SNAP_REG(RIO_SP_ERR[n].RIO_SP_RATE_EN),			\
+								SNAP_REG(RIO_SP_ERR[n].RIO_SP_ERR_ATTR_CAPT_DBG0),	\
+								SNAP_REG(RIO_SP_ERR[n].RIO_SP_ERR_CAPT_0_DBG1),	\
+								SNAP_REG(RIO_SP_ERR[n].RIO_SP_ERR_RATE),		\
+								SNAP_REG(RIO_SP_ERR[n].RIO_SP_ERR_THRESH),		\
+								SNAP_REG(RIO_PLM[n].RIO_PLM_SP_IMP_SPEC_CTL),	\
+								SNAP_REG(RIO_PLM[n].RIO_PLM_SP_STATUS),			\
+								SNAP_REG(RIO_PLM[n].RIO_PLM_SP_PATH_CTL)
+#define SNAP_LSU(n)				SNAP_REG(LSU_CMD[n].RIO_LSU_REG0),				\
+								SNAP_REG(LSU_CMD[n].RIO_LSU_REG1),				\
+								SNAP_REG(LSU_CMD[n].RIO_LSU_REG2),				\
+								SNAP_REG(LSU_CMD[n].RIO_LSU_REG3),				\
+								SNAP_REG(LSU_CMD[n].RIO_LSU_REG4),				\
+								SNAP_REG(LSU_CMD[n].RIO_LSU_REG5),				\
+								SNAP_REG(LSU_CMD[n].RIO_LSU_REG6)
+
+static const SnapReg	snap_regs[] =
+{
+	SNAP_REG(RIO_PID),
+	SNAP_REG(RIO_PCR),
+	SNAP_REG(RIO_PER_SET_CNTL),
+	SNAP_REG(RIO_GBL_EN),
+	SNAP_REG(RIO_GBL_EN_STAT),
+	SNAP_REG(RIO_DEV_ID),
+	SNAP_REG(RIO_DEV_INFO),
+	SNAP_REG(RIO_PE_FEAT),
+	SNAP_REG(RIO_SRC_OP),
+	SNAP_REG(RIO_DEST_OP),
+	SNAP_REG(RIO_PE_LL_CTL),
+	SNAP_REG(RIO_BASE_ID),
+	SNAP_REG(RIO_HOST_BASE_ID),
+	SNAP_REG(RIO_COMP_TAG),
+	SNAP_REG(RIO_SP_LT_CTL),
+	SNAP_REG(RIO_SP_RT_CTL),
+	SNAP_REG(RIO_SP_GEN_CTL),
+	SNAP_REG(RIO_ERR_DET),
+	SNAP_REG(RIO_ERR_EN),
+	SNAP_REG(RIO_H_ADDR_CAPT),
+	SNAP_REG(RIO_ADDR_CAPT),
+	SNAP_REG(RIO_ID_CAPT),
+	SNAP_REG(RIO_CTRL_CAPT),
+	SNAP_SP(0), SNAP_SP(1), SNAP_SP(2), SNAP_SP(3),
+	SNAP_REG(RIO_PW_RX_STAT),
+	SNAP_REG(RIO_PW_RX_CAPT[0]),
+	SNAP_REG(RIO_PW_RX_CAPT[1]),
+	SNAP_REG(RIO_PW_RX_CAPT[2]),
+	SNAP_REG(RIO_PW_RX_CAPT[3]),
+	SNAP_REG(RIO_ERR_RST_EVNT_ICSR),
+	SNAP_REG(RIO_ERR_RST_EVNT_ICRR),
+	SNAP_REG(RIO_ERR_RST_EVNT_ICRR2),
+	SNAP_REG(RIO_ERR_RST_EVNT_ICRR3),
+	SNAP_LSU(0), SNAP_LSU(1), SNAP_LSU(2), SNAP_LSU(3),
+	SNAP_LSU(4), SNAP_LSU(5), SNAP_LSU(6), SNAP_LSU(7),
+	SNAP_REG(RIO_LSU_STAT_REG[0]),
+	SNAP_REG(RIO_LSU_STAT_REG[1]),
+	SNAP_REG(RIO_LSU_STAT_REG[2]),
+	SNAP_REG(RIO_LSU_STAT_REG[3]),
+	SNAP_REG(RIO_LSU_STAT_REG[4]),
+	SNAP_REG(RIO_LSU_STAT_REG[5])
+};
+
+static const char	*snap_serdes_names[SNAP_SERDES_WORDS] =
+{
+	"SRIO_SERDES_CFGPLL", "SRIO_SERDES_STS",
+	"SRIO_SERDES_CFGRX0", "SRIO_SERDES_CFGRX1", "SRIO_SERDES_CFGRX2", "SRIO_SERDES_CFGRX3",
+	"SRIO_SERDES_CFGTX0", "SRIO_SERDES_CFGTX1", "SRIO_SERDES_CFGTX2", "SRIO_SERDES_CFGTX3"
+};
+
+/*********************** snap_slot ********************
+****************************************************/
+static SrioSnapHdr	*snap_slot(int slot)
+{
+	return (SrioSnapHdr *)(SNAP_BASE_ADR + slot * SNAP_SLOT_SIZE);
+}
+
+/*********************** snap_skip ********************
+* Registers which are changed by reading (link-response valid bit,
+* LSU_Reg6 read allocates a shadow register set)
+****************************************************/
+static int	snap_skip(uint32_t ofs)
+{
+	uint8_t		port, lsu;
+
+	for(port=0; port<4; port++)
+		if(ofs == SNAP_OFS(RIO_SP[port].RIO_SP_LM_RESP)) return 1;
+	for(lsu=0; lsu<SRIO_LSU_NUM; lsu++)
+		if(ofs == SNAP_OFS(LSU_CMD[lsu].RIO_LSU_REG6)) return 1;
+	return 0;
+}
+
+/*********************** snap_local ********************
+* Capture SRIO MMR space and SERDES registers of this device
+****************************************************/
+static void	snap_local(SrioSnapHdr *hdr)
+{
+	const volatile uint32_t	*mmr = (const volatile uint32_t *)hSrio;
+	uint32_t	*w = (uint32_t *)(hdr + 1);
+	uint32_t	*sd = w + SNAP_SRIO_WORDS;
+	uint32_t	i;
+	Uint16		pll;
+
+	hdr->tsc = CSL_tscRead();
+	for(i=0; i<SNAP_SRIO_WORDS; i++)
+		w[i] = snap_skip(i*4) ? 0 : mmr[i];
+
+	CSL_BootCfgGetSRIOSERDESConfigPLL (&pll);
+	sd[0] = pll;
+	CSL_BootCfgGetSRIOSERDESStatus (&sd[1]);
+	for(i=0; i<4; i++) {
+		CSL_BootCfgGetSRIOSERDESRxConfig (i, &sd[2+i]);
+		CSL_BootCfgGetSRIOSERDESTxConfig (i, &sd[6+i]);
+	}
+
+	hdr->magic       = SNAP_MAGIC;
+	hdr->flags       = 0;
+	hdr->destId      = main_deviceID;
+	hdr->srioWords   = SNAP_SRIO_WORDS;
+	hdr->serdesWords = SNAP_SERDES_WORDS;
+	hdr->errors      = 0;
+}
+
+/*********************** snap_remote ********************
+* Capture RapidIO configuration space of the remote device by
+* maintenance reads, SRIO_STRIPE_WINDOW reads in progress
+****************************************************/
+static int	snap_remote(SrioSnapHdr *hdr, uint16_t destId, uint8_t hop)
+{
+	uint32_t	*w = (uint32_t *)(hdr + 1);
+	SrioOp		ops[SRIO_STRIPE_WINDOW];
+	SrioXfer	x;
+	uint32_t	ofs = 0, errors = 0;
+	int			first = 0, num = 0, cc;
+
+	memset(w, 0, SNAP_SRIO_WORDS * 4 + SNAP_SERDES_WORDS * 4);
+	memset(&x, 0, sizeof(x));
+	x.destId   = destId;
+	x.idSize   = id_size;
+	x.ftype    = SRIO_FTYPE_MAINT;
+	x.ttype    = SRIO_TTYPE_MAINT_RD;
+	x.hopCount = hop;
+	x.size     = 4;
+	x.outPort  = srio_port_next(destId);
+	srio_xfer_class(&x, SRIO_CLASS_BULK);
+
+	hdr->tsc = CSL_tscRead();
+	CACHE_wbInvL1d(hdr, sizeof(*hdr) + SNAP_SRIO_WORDS * 4, CACHE_WAIT);	// no dirty line over the DMA data
+	while(ofs < SNAP_REMOTE_CFG_SIZE || num) {
+		if(num == SRIO_STRIPE_WINDOW || (ofs >= SNAP_REMOTE_CFG_SIZE && num)) {
+			cc = srio_xfer_wait(&ops[first]);
+			if(cc == SRIO_CC_LINK_DOWN || cc == SRIO_CC_SW_TIMEOUT) return cc;
+			if(cc != SRIO_CC_OK) errors++;
+			first = (first + 1) % SRIO_STRIPE_WINDOW;
+			num--;
+			continue;
+		}
+		x.remoteAdr = ofs;
+		x.localAdr  = (uint32_t)&w[(SNAP_CFG_OFS + ofs) / 4];
+		cc = srio_xfer_issue(srio_lsu_select(SRIO_CLASS_BULK), &x, &ops[(first + num) % SRIO_STRIPE_WINDOW]);
+		if(cc != SRIO_CC_OK) return cc;
+		num++;
+		ofs += 4;
+	}
+	CACHE_invL1d(w, SNAP_SRIO_WORDS * 4, CACHE_WAIT);
+
+	hdr->magic       = SNAP_MAGIC;
+	hdr->flags       = SNAP_FLAG_REMOTE;
+	hdr->destId      = destId;
+	hdr->srioWords   = SNAP_SRIO_WORDS;
+	hdr->serdesWords = 0;
+	hdr->errors      = errors;
+	return SRIO_CC_OK;
+}
+
+/*********************** snap_name ********************
+* Name of the register at SRIO MMR offset
+****************************************************/
+static const char	*snap_name(uint32_t ofs, char *buf)
+{
+	int		i;
+
+	for(i=0; i<sizeof(snap_regs)/sizeof(snap_regs[0]); i++)
+		if(snap_regs[i].ofs == ofs) return snap_regs[i].name;
+	sprintf(buf, "SRIO+0x%05lX", ofs);
+	return buf;
+}
+
+/*********************** snap_check ********************
+****************************************************/
+static SrioSnapHdr	*snap_check(const char *arg)
+{
+	char			*end;
+	uint32_t		slot = strtoul(arg, &end, 10);
+	SrioSnapHdr		*hdr;
+
+	if(slot >= SNAP_SLOTS) {
+		printf("### snap: bad slot '%s' (0..%d)\n", arg, SNAP_SLOTS-1);
+		return NULL;
+	}
+	hdr = snap_slot(slot);
+	if(hdr->magic != SNAP_MAGIC) {
+		printf("### snap: slot %lu is empty\n", slot);
+		return NULL;
+	}
+	return hdr;
+}
+
+///////////////////////////////////////////////////////////////
+////////// snapFunc() /////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int snapFunc(char *cmdStr)
+{
+	dbg_printf("SNAP: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, i, cc;
+	char		*end;
+	uint32_t	slot = 0;
+	SrioSnapHdr	*hdr;
+	uint64_t	t0;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+
+	if(argc == 0) {
+		for(i=0; i<SNAP_SLOTS; i++) {
+			hdr = snap_slot(i);
+			if(hdr->magic != SNAP_MAGIC)	printf("SNAP %d: empty\n", i);
+			else	printf("SNAP %d: %s ID 0x%lX, %lu SRIO words, %lu SERDES words, %lu errors, time %lu us\n",
+						i, (hdr->flags & SNAP_FLAG_REMOTE) ? "remote" : "local ", hdr->destId,
+						hdr->srioWords, hdr->serdesWords, hdr->errors, (uint32_t)(hdr->tsc / CPU_FREQ_MHZ));
+		}
+		return 0;
+	}
+
+	if(strcmp(args[0], "show") == 0 && argc > 1) {
+		const uint32_t	*w;
+		if((hdr = snap_check(args[1])) == NULL) return -1;
+		w = (const uint32_t *)(hdr + 1);
+		for(i=0; i<sizeof(snap_regs)/sizeof(snap_regs[0]); i++)
+			printf("%-40s 0x%08lX\n", snap_regs[i].name, w[snap_regs[i].ofs / 4]);
+		for(i=0; i<hdr->serdesWords; i++)
+			printf("%-40s 0x%08lX\n", snap_serdes_names[i], w[hdr->srioWords + i]);
+		return 0;
+	}
+
+	slot = strtoul(args[0], &end, 10);
+	if(slot >= SNAP_SLOTS) {
+		printf("### snap: bad slot '%s' (0..%d)\n", args[0], SNAP_SLOTS-1);
+		return -1;
+	}
+	hdr = snap_slot(slot);
+	hdr->magic = 0;
+
+	t0 = CSL_tscRead();
+	if(argc > 2 && strcmp(args[1], "remote") == 0) {
+		uint16_t	destId = strtoul(args[2], &end, 16);
+		uint8_t		hop = (argc > 3) ? strtoul(args[3], &end, 10) : 0;
+		if((cc = snap_remote(hdr, destId, hop)) != SRIO_CC_OK) {
+			printf("### snap: remote capture error: %s\n", srio_cc_str(cc));
+			return -1;
+		}
+	}
+	else if(argc == 1) {
+		snap_local(hdr);
+	}
+	else {
+		printf("### snap: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	printf("SNAP %lu: %lu words captured in %lu us", slot, hdr->srioWords + hdr->serdesWords,
+		(uint32_t)((CSL_tscRead() - t0) / CPU_FREQ_MHZ));
+	if(hdr->errors) printf(", %lu maintenance reads failed", hdr->errors);
+	printf("\n");
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// snapdiffFunc() /////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int snapdiffFunc(char *cmdStr)
+{
+	dbg_printf("SNAPDIFF: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	char		buf[24];
+	SrioSnapHdr	*a, *b;
+	const uint32_t	*wa, *wb;
+	uint32_t	i, n, diffs = 0;
+
+	if(parse_args(cmdStr, args, MAX_ARGS) < 2) {
+		printf("### snapdiff: two slots expected\n");
+		return -1;
+	}
+	if((a = snap_check(args[0])) == NULL || (b = snap_check(args[1])) == NULL)
+		return -1;
+	wa = (const uint32_t *)(a + 1);
+	wb = (const uint32_t *)(b + 1);
+
+	printf("REGISTER                                 SNAP %-8s SNAP %-8s CHANGED BITS\n", args[0], args[1]);
+	n = (a->srioWords < b->srioWords) ? a->srioWords : b->srioWords;
+	for(i=0; i<n; i++) {
+		if(wa[i] == wb[i]) continue;
+		printf("%-40s 0x%08lX    0x%08lX    0x%08lX\n", snap_name(i*4, buf), wa[i], wb[i], wa[i] ^ wb[i]);
+		diffs++;
+	}
+	n = (a->serdesWords < b->serdesWords) ? a->serdesWords : b->serdesWords;
+	for(i=0; i<n; i++) {
+		if(wa[a->srioWords + i] == wb[b->srioWords + i]) continue;
+		printf("%-40s 0x%08lX    0x%08lX    0x%08lX\n", snap_serdes_names[i],
+			wa[a->srioWords + i], wb[b->srioWords + i], wa[a->srioWords + i] ^ wb[b->srioWords + i]);
+		diffs++;
+	}
+	printf("SNAPDIFF: %lu registers differ\n", diffs);
+	return 0;
+}
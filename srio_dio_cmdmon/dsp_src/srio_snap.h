@@ -0,0 +1,43 @@
+/*
+ *  srio_snap.h
+ *
+ *  Snapshot and diff of the SRIO and SERDES registers.
+ */
+#ifndef SRIO_SNAP_H_
+#define SRIO_SNAP_H_
+
+#include <stdint.h>
+
+/* Snapshot slots (MSMC SRAM) */
+#define SNAP_BASE_ADR			0x0C300000
+#define SNAP_SLOT_SIZE			0x00040000
+#define SNAP_SLOTS				4
+
+/* Snapshot header magic ('SNAP') */
+#define SNAP_MAGIC				0x50414E53
+
+/* Remote snapshot: RapidIO configuration space captured by maintenance reads */
+#define SNAP_REMOTE_CFG_SIZE	0x2000
+
+/* Snapshot flags */
+#define SNAP_FLAG_REMOTE		0x01
+
+/* SERDES words: PLL config, status, RX config[4], TX config[4] */
+#define SNAP_SERDES_WORDS		10
+
+/** Snapshot header, followed by SRIO MMR words and SERDES words */
+typedef struct
+{
+	uint32_t	magic;			/* SNAP_MAGIC */
+	uint32_t	flags;			/* SNAP_FLAG_xxx */
+	uint32_t	destId;			/* remote device ID */
+	uint32_t	srioWords;		/* words of SRIO MMR space */
+	uint32_t	serdesWords;	/* SNAP_SERDES_WORDS (0 for remote) */
+	uint32_t	errors;			/* failed maintenance reads */
+	uint64_t	tsc;			/* capture time */
+} SrioSnapHdr;
+
+int		snapFunc(char *cmdStr);
+int		snapdiffFunc(char *cmdStr);
+
+#endif /* SRIO_SNAP_H_ */
@@ -0,0 +1,298 @@
+/*
+ *  srio_trace.c
+ *
+ *  Fixed size in-memory trace of the SRIO transactions and events.
+ *
+ *  Every LSU issue and completion, inbound doorbell and port status change
+ *  is recorded as a 32 bytes binary entry. Writers only reserve the slot
+ *  with the interrupts disabled for a few cycles and never wait; readers
+ *  (the 'trace' command) detect the entries overwritten during reading
+ *  by the sequence number.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_srioAuxPhyLayer.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_trace.h"
+
+#define TRACE_MASK			(SRIO_TRACE_SIZE-1)
+#define TRACE_SEQ_INVALID	0xFFFFFFFF
+
+#pragma DATA_ALIGN(trace_ring, 128)
+static SrioTraceEntry		trace_ring[SRIO_TRACE_SIZE];
+static volatile uint32_t	trace_head = 0;		// sequence number of next entry
+
+volatile int				srio_trace_enable = 1;
+
+/**
+ *  @b Description
+ *  @n
+ *      Record the trace entry. Can be called from task and interrupt context.
+ */
+void	srio_trace_rec(uint8_t event, uint8_t lsu, uint16_t destId, uint32_t addr,
+					   uint32_t size, uint8_t type, uint8_t cc, uint16_t info, uint32_t lat)
+{
+	SrioTraceEntry	*e;
+	uint32_t		seq;
+	uint32_t		csr;
+
+	if(srio_trace_enable == 0) return;
+
+	/* Reserve the slot */
+	csr = _disable_interrupts();
+	seq = trace_head++;
+	_restore_interrupts(csr);
+
+	e = &trace_ring[seq & TRACE_MASK];
+	e->seq    = TRACE_SEQ_INVALID;
+	e->tsc    = CSL_tscRead();
+	e->addr   = addr;
+	e->size   = size;
+	e->lat    = lat;
+	e->destId = destId;
+	e->info   = info;
+	e->event  = event;
+	e->lsu    = lsu;
+	e->type   = type;
+	e->cc     = cc;
+	e->seq    = seq;		// entry is valid
+}
+
+/*********************** trace_get ********************
+* Copy entry with sequence number seq. Return 0 if the entry
+* is overwritten or not completed yet.
+****************************************************/
+static int	trace_get(uint32_t seq, SrioTraceEntry *dst)
+{
+	const volatile SrioTraceEntry *e = &trace_ring[seq & TRACE_MASK];
+
+	if(e->seq != seq) return 0;
+	memcpy(dst, (const void *)e, sizeof(SrioTraceEntry));
+	if(e->seq != seq) return 0;		// overwritten during copy
+	return 1;
+}
+
+/*********************** trace_first ********************
+* Sequence number of the oldest entry of last num entries
+****************************************************/
+static uint32_t	trace_first(uint32_t head, uint32_t num)
+{
+	if(num > SRIO_TRACE_SIZE) num = SRIO_TRACE_SIZE;
+	if(num > head) num = head;
+	return head - num;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Record the port status changes and new inbound doorbells.
+ *      Called periodically from the command loop.
+ */
+void	srio_trace_poll(void)
+{
+	static uint8_t	portState[4] = { 0xFF, 0xFF, 0xFF, 0xFF };
+	static uint16_t	dbState[4] = { 0, 0, 0, 0 };
+	uint8_t			port, ok;
+	Uint16			pending;
+
+	if(srio_trace_enable == 0) return;
+
+	for(port=0; port<4; port++) {
+		ok = (CSL_SRIO_IsPortOk (hSrio, port) == TRUE) ? 1 : 0;
+		if(ok != portState[port]) {
+			srio_trace_rec(TRC_EV_PORT, port, 0, hSrio->RIO_SP[port].RIO_SP_ERR_STAT,
+						   0, 0, ok, 0, 0);
+			portState[port] = ok;
+		}
+	}
+
+	for(port=0; port<4; port++) {
+		CSL_SRIO_GetDoorbellPendingInterrupt (hSrio, port, &pending);
+		if(pending & ~dbState[port])
+			srio_trace_rec(TRC_EV_DOORBELL, port, 0, 0, 0, SRIO_FTYPE_DOORBELL << 4,
+						   0, pending & ~dbState[port], 0);
+		dbState[port] = pending;
+	}
+}
+
+///////////////////////////////////////////////////////////////
+////////// trace export ///////////////////////////////////////
+///////////////////////////////////////////////////////////////
+static const char	*trace_ev_str(uint8_t event)
+{
+	switch(event) {
+	case TRC_EV_ISSUE:		return "ISSUE";
+	case TRC_EV_DONE:		return "DONE ";
+	case TRC_EV_DOORBELL:	return "DBELL";
+	case TRC_EV_PORT:		return "PORT ";
+	case TRC_EV_RECV:		return "RECV ";
+	}
+	return "?????";
+}
+
+static void	trace_dump(uint32_t num)
+{
+	SrioTraceEntry	e;
+	uint32_t		head = trace_head;
+	uint32_t		seq  = trace_first(head, num);
+	uint64_t		t0   = 0;
+	int				first = 1;
+
+	printf("    SEQ     TIME(us) EVENT LSU   ID  ADDRESS     SIZE  FT/TT   LAT(ns)  CC\n");
+	for( ; seq != head; seq++) {
+		if(trace_get(seq, &e) == 0) continue;
+		if(first) { t0 = e.tsc; first = 0; }
+
+		uint32_t	us = (uint32_t)((e.tsc - t0) / CPU_FREQ_MHZ);
+
+		switch(e.event) {
+		case TRC_EV_ISSUE:
+			printf("%7lu %12lu %s %3d %04X  0x%08lX %6lu  %2d/%-2d\n",
+				e.seq, us, trace_ev_str(e.event), e.lsu, e.destId,
+				e.addr, e.size, e.type >> 4, e.type & 0xF);
+			break;
+		case TRC_EV_DONE:
+			printf("%7lu %12lu %s %3d %04X  0x%08lX %6lu  %2d/%-2d %9lu  %s\n",
+				e.seq, us, trace_ev_str(e.event), e.lsu, e.destId,
+				e.addr, e.size, e.type >> 4, e.type & 0xF,
+				(uint32_t)(((uint64_t)e.lat * 1000) / CPU_FREQ_MHZ), srio_cc_str(e.cc));
+			break;
+		case TRC_EV_RECV:
+			printf("%7lu %12lu %s     %04X  0x%08lX %6lu  %2d/%-2d %9lu\n",
+				e.seq, us, trace_ev_str(e.event), e.destId,
+				e.addr, e.size, e.type >> 4, e.type & 0xF, (uint32_t)(((uint64_t)e.lat * 1000) / CPU_FREQ_MHZ));
+			break;
+		case TRC_EV_DOORBELL:
+			printf("%7lu %12lu %s reg %d bits 0x%04X\n",
+				e.seq, us, trace_ev_str(e.event), e.lsu, e.info);
+			break;
+		case TRC_EV_PORT:
+			printf("%7lu %12lu %s port %d %s (SP_ERR_STAT = 0x%08lX)\n",
+				e.seq, us, trace_ev_str(e.event), e.lsu, e.cc ? "OK" : "DOWN", e.addr);
+			break;
+		default:
+			printf("%7lu %12lu %s\n", e.seq, us, trace_ev_str(e.event));
+			break;
+		}
+	}
+}
+
+/*********************** trace_copy ********************
+* Copy binary export (header and entries) to memory
+****************************************************/
+static uint32_t	trace_copy(uint32_t adr)
+{
+	SrioTraceHdr	*hdr = (SrioTraceHdr *)adr;
+	SrioTraceEntry	*dst = (SrioTraceEntry *)(adr + sizeof(SrioTraceHdr));
+	uint32_t		head = trace_head;
+	uint32_t		seq  = trace_first(head, SRIO_TRACE_SIZE);
+	uint32_t		count = 0;
+
+	for( ; seq != head; seq++)
+		if(trace_get(seq, &dst[count]) != 0) count++;
+
+	hdr->magic     = SRIO_TRACE_MAGIC;
+	hdr->version   = SRIO_TRACE_VERSION;
+	hdr->entrySize = sizeof(SrioTraceEntry);
+	hdr->count     = count;
+	hdr->cpuMHz    = CPU_FREQ_MHZ;
+
+	return count;
+}
+
+/*********************** trace_save ********************
+* Write binary export (header and entries) to host file
+****************************************************/
+static int	trace_save(const char *name)
+{
+	SrioTraceHdr	hdr;
+	SrioTraceEntry	e;
+	uint32_t		head = trace_head;
+	uint32_t		seq;
+	FILE			*fp;
+
+	fp = fopen(name, "wb");
+	if(fp == NULL) {
+		printf("### trace: can't open file '%s'\n", name);
+		return -1;
+	}
+
+	hdr.magic     = SRIO_TRACE_MAGIC;
+	hdr.version   = SRIO_TRACE_VERSION;
+	hdr.entrySize = sizeof(SrioTraceEntry);
+	hdr.count     = 0;
+	hdr.cpuMHz    = CPU_FREQ_MHZ;
+	for(seq = trace_first(head, SRIO_TRACE_SIZE); seq != head; seq++)
+		if(trace_get(seq, &e) != 0) hdr.count++;
+
+	fwrite(&hdr, sizeof(hdr), 1, fp);
+	for(seq = trace_first(head, SRIO_TRACE_SIZE); seq != head && hdr.count; seq++) {
+		if(trace_get(seq, &e) == 0) continue;
+		fwrite(&e, sizeof(e), 1, fp);
+		hdr.count--;
+	}
+	fclose(fp);
+
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// traceFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int traceFunc(char *cmdStr)
+{
+	dbg_printf("TRACE: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc;
+	char		*end;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+
+	if(argc == 0) {
+		printf("TRACE: %s, %lu entries recorded (ring %d entries)\n",
+			srio_trace_enable ? "on" : "off", trace_head, SRIO_TRACE_SIZE);
+	}
+	else if(strcmp(args[0], "on") == 0) {
+		srio_trace_enable = 1;
+	}
+	else if(strcmp(args[0], "off") == 0) {
+		srio_trace_enable = 0;
+	}
+	else if(strcmp(args[0], "clr") == 0) {
+		uint32_t	csr = _disable_interrupts();
+		memset(trace_ring, 0xFF, sizeof(trace_ring));
+		trace_head = 0;
+		_restore_interrupts(csr);
+	}
+	else if(strcmp(args[0], "dump") == 0) {
+		uint32_t	num = 32;
+		if(argc > 1) num = strtoul(args[1], &end, 10);
+		trace_dump(num);
+	}
+	else if(strcmp(args[0], "copy") == 0 && argc > 1) {
+		uint32_t	adr = strtoul(args[1], &end, 16);
+		uint32_t	count = trace_copy(adr);
+		printf("TRACE: %lu entries copied to 0x%08lX (%lu bytes)\n", count, adr,
+			sizeof(SrioTraceHdr) + count * sizeof(SrioTraceEntry));
+	}
+	else if(strcmp(args[0], "save") == 0 && argc > 1) {
+		if(trace_save(args[1]) < 0) return -1;
+		printf("TRACE: saved to '%s'\n", args[1]);
+	}
+	else {
+		printf("### trace: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+
+	return 0;
+}
@@ -0,0 +1,58 @@
+/*
+ *  srio_trace.h
+ *
+ *  Fixed size in-memory trace of the SRIO transactions and events.
+ */
+#ifndef SRIO_TRACE_H_
+#define SRIO_TRACE_H_
+
+#include <stdint.h>
+
+/* Number of entries in trace ring (must be power of 2) */
+#define SRIO_TRACE_SIZE			1024
+
+/* Trace event types */
+#define TRC_EV_ISSUE			1	/* LSU request issued */
+#define TRC_EV_DONE				2	/* LSU request completed */
+#define TRC_EV_DOORBELL			3	/* inbound doorbell pending */
+#define TRC_EV_PORT				4	/* port status change */
+#define TRC_EV_RECV				5	/* message received, lat = one-way latency */
+
+/* Binary export header magic ('STRC') and version */
+#define SRIO_TRACE_MAGIC		0x43525453
+#define SRIO_TRACE_VERSION		1
+
+/** Trace entry (32 bytes) */
+typedef struct
+{
+	uint64_t	tsc;			/* CSL_tscRead() at record time */
+	uint32_t	seq;			/* entry sequence number */
+	uint32_t	addr;			/* RapidIO address / SP_ERR_STAT */
+	uint32_t	size;			/* byte count */
+	uint32_t	lat;			/* issue to completion time (TSC ticks) */
+	uint16_t	destId;			/* destination device ID */
+	uint16_t	info;			/* transaction ID / doorbell bits */
+	uint8_t		event;			/* TRC_EV_xxx */
+	uint8_t		lsu;			/* LSU or port number */
+	uint8_t		type;			/* ftype << 4 | ttype */
+	uint8_t		cc;				/* completion code / port status */
+} SrioTraceEntry;
+
+/** Header of the binary trace export */
+typedef struct
+{
+	uint32_t	magic;			/* SRIO_TRACE_MAGIC */
+	uint16_t	version;		/* SRIO_TRACE_VERSION */
+	uint16_t	entrySize;		/* sizeof(SrioTraceEntry) */
+	uint32_t	count;			/* number of entries followed */
+	uint32_t	cpuMHz;			/* TSC frequency */
+} SrioTraceHdr;
+
+extern volatile int	srio_trace_enable;
+
+void	srio_trace_rec(uint8_t event, uint8_t lsu, uint16_t destId, uint32_t addr,
+					   uint32_t size, uint8_t type, uint8_t cc, uint16_t info, uint32_t lat);
+void	srio_trace_poll(void);
+int		traceFunc(char *cmdStr);
+
+#endif /* SRIO_TRACE_H_ */
@@ -0,0 +1,322 @@
+/*
+ *  srio_tsync.c
+ *
+ *  TSC time synchronization between boards over SRIO.
+ *
+ *  The requester posts its TSC t1 into the time sync block of the peer.
+ *  The peer takes t2 when it sees the request and t3 just before it
+ *  posts the response with t1, t2 and t3 back; the requester takes t4
+ *  when it sees the response. As in NTP:
+ *
+ *      offset = ((t2 - t1) + (t3 - t4)) / 2	(peer - local TSC)
+ *      rtt    = (t4 - t1) - (t3 - t2)
+ *
+ *  Out of TSYNC_SAMPLES exchanges the one with the smallest rtt is used.
+ *  Every later sync of the same peer updates the drift (clock rate
+ *  difference) from the offset change, so srio_tsync_offset() can give
+ *  the offset at any time. The offset assumes equal delays in both
+ *  directions; later one-way measurements ('tsync lat') show when the
+ *  two directions of a link stop being equal.
+ */
+#include <string.h>
+#include <stdlib.h>
+#include <stddef.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_tsync.h"
+
+static SrioTsyncBlock	*tsync_blk = (SrioTsyncBlock *)TSYNC_BASE_ADR;
+static SrioTsyncPeer	tsync_peer[TSYNC_PEER_MAX];
+static uint32_t			tsync_seq;			/* last own request */
+static uint32_t			tsync_done;			/* last request served */
+
+/**
+ *  @b Description
+ *  @n
+ *      Reset the own time sync block, so that the boot contents of the
+ *      memory are not taken for a request.
+ */
+void	srio_tsync_init(void)
+{
+	memset(tsync_blk, 0, sizeof(SrioTsyncBlock));
+	tsync_seq  = 0;
+	tsync_done = 0;
+}
+
+/*********************** tsync_find ********************
+* Peer entry, added if add != 0
+****************************************************/
+static SrioTsyncPeer	*tsync_find(uint16_t peerId, int add)
+{
+	int		i;
+
+	for(i=0; i<TSYNC_PEER_MAX; i++)
+		if(tsync_peer[i].valid && tsync_peer[i].peerId == peerId)
+			return &tsync_peer[i];
+	if(add == 0) return NULL;
+	for(i=0; i<TSYNC_PEER_MAX; i++) {
+		if(tsync_peer[i].valid) continue;
+		memset(&tsync_peer[i], 0, sizeof(SrioTsyncPeer));
+		tsync_peer[i].peerId = peerId;
+		tsync_peer[i].valid  = 1;
+		return &tsync_peer[i];
+	}
+	return NULL;
+}
+
+/*********************** tsync_exchange ********************
+* One timestamp exchange, t[0..3] = t1..t4
+****************************************************/
+static int	tsync_exchange(uint16_t peerId, uint64_t t[4])
+{
+	SrioTsyncMsg	*req  = &tsync_blk->reqOut;
+	SrioTsyncMsg	*resp = &tsync_blk->resp;
+	uint64_t		tEnd;
+	int				cc;
+
+	memset(req, 0, sizeof(*req));
+	req->srcId	  = main_deviceID;
+	req->replyAdr = srio_global_adr((uint32_t)resp);
+	if((++tsync_seq & 0xFFFF) == 0) tsync_seq++;
+	req->seq	  = ((uint32_t)main_deviceID << 16) | (tsync_seq & 0xFFFF);
+	req->t1		  = CSL_tscRead();
+
+	cc = srio_xfer_post(peerId, TSYNC_BASE_ADR + offsetof(SrioTsyncBlock, req), req,
+						offsetof(SrioTsyncMsg, seq), offsetof(SrioTsyncMsg, seq), TSYNC_DB_INFO);
+	if(cc != SRIO_CC_OK) return cc;
+
+	tEnd = CSL_tscRead() + (uint64_t)TSYNC_WAIT_US * CPU_FREQ_MHZ;
+	do {
+		CACHE_invL1d((void *)&resp->seq, 4, CACHE_WAIT);
+		if(resp->seq == req->seq) {
+			t[3] = CSL_tscRead();
+			CACHE_invL1d(resp, sizeof(*resp), CACHE_WAIT);
+			t[0] = resp->t1;
+			t[1] = resp->t2;
+			t[2] = resp->t3;
+			return SRIO_CC_OK;
+		}
+	} while(CSL_tscRead() < tEnd);
+	return SRIO_CC_SW_TIMEOUT;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Measure the clock offset of the peer and update its drift.
+ *
+ *  @param[in]  samples
+ *      Number of exchanges (0 - TSYNC_SAMPLES), the fastest one is used
+ *
+ *  @retval
+ *      SRIO_CC_xxx
+ */
+int	srio_tsync_run(uint16_t peerId, int samples)
+{
+	SrioTsyncPeer	*p;
+	uint64_t		t[4];
+	int64_t			offset = 0, off;
+	uint32_t		rtt, best = 0xFFFFFFFF;
+	uint64_t		ref = 0;
+	int				i, cc = SRIO_CC_SW_TIMEOUT;
+
+	if(samples <= 0) samples = TSYNC_SAMPLES;
+	for(i=0; i<samples; i++) {
+		if(tsync_exchange(peerId, t) != SRIO_CC_OK) continue;
+		rtt = (uint32_t)((t[3] - t[0]) - (t[2] - t[1]));
+		if(rtt >= best) continue;
+		best   = rtt;
+		offset = ((int64_t)(t[1] - t[0]) + (int64_t)(t[2] - t[3])) / 2;
+		ref    = t[0] + (t[3] - t[0]) / 2;
+		cc     = SRIO_CC_OK;
+	}
+	if(cc != SRIO_CC_OK) return cc;
+
+	if((p = tsync_find(peerId, 1)) == NULL) return SRIO_CC_INVALID;
+	if(p->syncs && ref > p->ref) {
+		off = offset - p->offset;
+		p->driftPpb = (int32_t)((off * 1000000000LL) / (int64_t)(ref - p->ref));
+	}
+	p->offset = offset;
+	p->ref	  = ref;
+	p->rtt	  = best;
+	p->syncs++;
+	return SRIO_CC_OK;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Clock offset of the peer (peer - local TSC) at the local time.
+ *
+ *  @retval
+ *      0 - Success, -1 - the peer is not synchronized
+ */
+int	srio_tsync_offset(uint16_t peerId, uint64_t localTsc, int64_t *offset)
+{
+	SrioTsyncPeer	*p = tsync_find(peerId, 0);
+
+	if(p == NULL) return -1;
+	*offset = p->offset + ((int64_t)(localTsc - p->ref) * p->driftPpb) / 1000000000LL;
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Answer a new time sync request. Called periodically from the
+ *      command loop.
+ *
+ *  @retval
+ *      1 - request answered, 0 - no request
+ */
+int	srio_tsync_poll(void)
+{
+	SrioTsyncMsg	*req  = &tsync_blk->req;
+	SrioTsyncMsg	*resp = &tsync_blk->respOut;
+	uint64_t		t2;
+	Uint16			pending;
+
+	CACHE_invL1d((void *)&req->seq, 4, CACHE_WAIT);
+	if(req->seq == tsync_done) return 0;
+	t2 = CSL_tscRead();
+
+	CSL_SRIO_GetDoorbellPendingInterrupt (hSrio, TSYNC_DB_REG, &pending);
+	if(pending & (1 << TSYNC_DB_BIT))
+		CSL_SRIO_ClearDoorbellPendingInterrupt (hSrio, TSYNC_DB_REG, 1 << TSYNC_DB_BIT);
+
+	CACHE_invL1d(req, sizeof(*req), CACHE_WAIT);
+	tsync_done = req->seq;
+	memcpy(resp, req, sizeof(*resp));
+	resp->t2 = t2;
+	resp->t3 = CSL_tscRead();
+	srio_xfer_post(req->srcId, req->replyAdr, resp,
+				   offsetof(SrioTsyncMsg, seq), offsetof(SrioTsyncMsg, seq), TSYNC_DB_INFO);
+	return 1;
+}
+
+/*********************** tsync_show ********************
+****************************************************/
+static void	tsync_show(void)
+{
+	int64_t		offset;
+	uint64_t	now = CSL_tscRead();
+	int			i;
+
+	printf("TSYNC: peer offsets (peer - local, at now)\n");
+	for(i=0; i<TSYNC_PEER_MAX; i++) {
+		const SrioTsyncPeer	*p = &tsync_peer[i];
+
+		if(p->valid == 0) continue;
+		srio_tsync_offset(p->peerId, now, &offset);
+		printf("  0x%04X: offset %s%lu.%03lu us, drift %ld ppb, rtt %lu ns, %lu syncs, %lu s ago\n",
+			p->peerId, offset < 0 ? "-" : "",
+			(uint32_t)((offset < 0 ? -offset : offset) / CPU_FREQ_MHZ),
+			(uint32_t)(((offset < 0 ? -offset : offset) % CPU_FREQ_MHZ) * 1000 / CPU_FREQ_MHZ),
+			p->driftPpb, (p->rtt * 1000) / CPU_FREQ_MHZ, p->syncs,
+			(uint32_t)((now - p->ref) / ((uint64_t)CPU_FREQ_MHZ * 1000000)));
+	}
+}
+
+/*********************** tsync_lat ********************
+* One-way latency of both directions by count exchanges
+****************************************************/
+static int	tsync_lat(uint16_t peerId, uint32_t count)
+{
+	uint64_t	t[4];
+	int64_t		offset, fwd, bwd;
+	int64_t		fwdMin = 0x7FFFFFFF, bwdMin = 0x7FFFFFFF, fwdSum = 0, bwdSum = 0;
+	uint32_t	n, ok = 0;
+
+	if(srio_tsync_offset(peerId, CSL_tscRead(), &offset) < 0) {
+		printf("### tsync: peer 0x%X is not synchronized (see 'tsync <IdHex>')\n", peerId);
+		return -1;
+	}
+	for(n=0; n<count; n++) {
+		if(tsync_exchange(peerId, t) != SRIO_CC_OK) continue;
+		srio_tsync_offset(peerId, t[0], &offset);
+		fwd = (int64_t)(t[1] - t[0]) - offset;		/* local -> peer */
+		bwd = (int64_t)(t[3] - t[2]) + offset;		/* peer -> local */
+		if(fwd < fwdMin) fwdMin = fwd;
+		if(bwd < bwdMin) bwdMin = bwd;
+		fwdSum += fwd;
+		bwdSum += bwd;
+		ok++;
+	}
+	if(ok == 0) {
+		printf("### TSYNC: no response from 0x%X\n", peerId);
+		return -1;
+	}
+	printf("TSYNC: one-way 0x%X -> 0x%X: min %ld ns, avg %ld ns\n", main_deviceID, peerId,
+		(int32_t)(fwdMin * 1000 / CPU_FREQ_MHZ), (int32_t)(fwdSum * 1000 / CPU_FREQ_MHZ / ok));
+	printf("TSYNC: one-way 0x%X -> 0x%X: min %ld ns, avg %ld ns (%lu of %lu)\n", peerId, main_deviceID,
+		(int32_t)(bwdMin * 1000 / CPU_FREQ_MHZ), (int32_t)(bwdSum * 1000 / CPU_FREQ_MHZ / ok), ok, count);
+	return 0;
+}
+
+///////////////////////////////////////////////////////////////
+////////// tsyncFunc() ////////////////////////////////////////
+///////////////////////////////////////////////////////////////
+int tsyncFunc(char *cmdStr)
+{
+	dbg_printf("TSYNC: %s\n", cmdStr);
+
+	char		args[MAX_ARGS][MAX_ARG_LEN];
+	int			argc, cc;
+	char		*end;
+	uint32_t	peerId, n;
+	uint64_t	t0;
+
+	argc = parse_args(cmdStr, args, MAX_ARGS);
+	if(argc == 0) {
+		tsync_show();
+		return 0;
+	}
+
+	if(strcmp(args[0], "clr") == 0) {
+		memset(tsync_peer, 0, sizeof(tsync_peer));
+		return 0;
+	}
+
+	if(strcmp(args[0], "serve") == 0) {
+		n  = (argc > 1) ? strtoul(args[1], &end, 10) : 10;
+		t0 = CSL_tscRead();
+		while(CSL_tscRead() - t0 < (uint64_t)n * CPU_FREQ_MHZ * 1000000) {
+			srio_tsync_poll();
+			cmd_idle();
+		}
+		return 0;
+	}
+
+	if(strcmp(args[0], "lat") == 0 && argc >= 2) {
+		peerId = strtoul(args[1], &end, 16);
+		n = (argc > 2) ? strtoul(args[2], &end, 10) : 100;
+		return tsync_lat(peerId, n ? n : 1);
+	}
+
+	peerId = strtoul(args[0], &end, 16);
+	if(end == args[0]) {
+		printf("### tsync: bad arguments '%s'\n", cmdStr);
+		return -1;
+	}
+	if(id_size == SRIO_ID_8BIT && peerId > 0xFF) {
+		printf("### tsync: ID 0x%lX is too large for 8-bit ID size (see 'idsize')\n", peerId);
+		return -1;
+	}
+	n = (argc > 1) ? strtoul(args[1], &end, 10) : TSYNC_SAMPLES;
+	if((cc = srio_tsync_run(peerId, n)) != SRIO_CC_OK) {
+		printf("### TSYNC 0x%lX Error: %s\n", peerId, srio_cc_str(cc));
+		return -1;
+	}
+	tsync_show();
+	return 0;
+}
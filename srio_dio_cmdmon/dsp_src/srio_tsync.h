@@ -0,0 +1,63 @@
+/*
+ *  srio_tsync.h
+ *
+ *  TSC time synchronization between boards over SRIO.
+ */
+#ifndef SRIO_TSYNC_H_
+#define SRIO_TSYNC_H_
+
+#include <stdint.h>
+
+/* Time sync block (global address of core 0 L2), same on all boards */
+#define TSYNC_BASE_ADR			0x1087A000
+
+/* Doorbell sent with the messages: register 3, bit 2 */
+#define TSYNC_DB_REG			3
+#define TSYNC_DB_BIT			2
+#define TSYNC_DB_INFO			((TSYNC_DB_REG << 5) | TSYNC_DB_BIT)
+
+#define TSYNC_PEER_MAX			16
+#define TSYNC_SAMPLES			16		/* exchanges per sync, the fastest one is used */
+#define TSYNC_WAIT_US			10000	/* max wait for the response */
+
+/** Timestamp exchange message, the sender writes seq last */
+typedef struct
+{
+	uint64_t			t1;			/* request sent (requester TSC) */
+	uint64_t			t2;			/* request seen (responder TSC) */
+	uint64_t			t3;			/* response sent (responder TSC) */
+	uint32_t			replyAdr;	/* requester block (global address) */
+	uint16_t			srcId;		/* requester device ID */
+	uint16_t			rsvd;
+	uint32_t			rsvd1;
+	volatile uint32_t	seq;
+} SrioTsyncMsg;
+
+/** Time sync block of a monitor */
+typedef struct
+{
+	SrioTsyncMsg		req;		/* inbound request */
+	SrioTsyncMsg		reqOut;		/* outbound request */
+	SrioTsyncMsg		resp;		/* response to own request */
+	SrioTsyncMsg		respOut;	/* outbound response */
+} SrioTsyncBlock;
+
+/** Clock of a peer: peer TSC = local TSC + offset + drift since ref */
+typedef struct
+{
+	uint16_t	peerId;
+	uint8_t		valid;
+	int64_t		offset;			/* peer - local TSC at ref */
+	uint64_t	ref;			/* local TSC of the offset */
+	int32_t		driftPpb;		/* peer clock rate - local, parts per billion */
+	uint32_t	rtt;			/* round trip of the used exchange (ticks) */
+	uint32_t	syncs;
+} SrioTsyncPeer;
+
+void		srio_tsync_init(void);
+int			srio_tsync_run(uint16_t peerId, int samples);
+int			srio_tsync_offset(uint16_t peerId, uint64_t localTsc, int64_t *offset);
+int			srio_tsync_poll(void);
+int			tsyncFunc(char *cmdStr);
+
+#endif /* SRIO_TSYNC_H_ */
@@ -0,0 +1,831 @@
+/*
+ *  srio_xfer.c
+ *
+ *  DirectIO (LSU) transfer layer of the SRIO Command Monitor.
+ *  All LSU programming of the monitor goes through this file.
+ */
+#include <string.h>
+#include <c6x.h>
+/* CSL SRIO Functional Layer */
+#include <ti/csl/csl_srio.h>
+#include <ti/csl/csl_srioAux.h>
+#include <ti/csl/csl_cacheAux.h>
+#include <ti/csl/csl_tsc.h>
+
+#include <dzy/stdio.h>
+
+#include "cmdmon.h"
+#include "srio_xfer.h"
+#include "srio_trace.h"
+#include "srio_link.h"
+#include "srio_route.h"
+
+/* LSU_Reg4 PRIORITY field = {VC, PRIO[1:0], CRF}, VC is not used */
+#define SRIO_LSU_PRIO(prio, crf)	((((prio) & 0x3) << 1) | ((crf) & 0x1))
+
+/* Default classes: control traffic on LSU 0-1 at priority 2 with CRF,
+ * bulk traffic on LSU 2-7 at priority 0. */
+SrioClassCfg	srio_class_cfg[SRIO_CLASS_NUM] =
+{
+	{ 2, 1, 0x03 },		// SRIO_CLASS_CTRL
+	{ 0, 0, 0xFC }		// SRIO_CLASS_BULK
+};
+
+/* Destination reached through each port (set by 'ports dest') */
+uint32_t	srio_port_dest[4] = { SRIO_PORT_DEST_ANY, SRIO_PORT_DEST_ANY, SRIO_PORT_DEST_ANY, SRIO_PORT_DEST_ANY };
+/* Bytes issued on each port */
+uint32_t	srio_port_bytes[4] = { 0, 0, 0, 0 };
+
+/* Transaction policy (set by 'retry') */
+SrioXferPolicy	srio_xfer_policy = { SRIO_XFER_TIMEOUT_US, SRIO_XFER_RETRIES, SRIO_BACKOFF_US, SRIO_BACKOFF_MAX_US };
+uint32_t		srio_xfer_retried;		/* retries done by srio_xfer() */
+uint32_t		srio_xfer_failed;		/* srio_xfer() failures after the retries */
+
+/* Requests of this core in progress per LSU and output port (see srio_lsu_flush()) */
+uint16_t		srio_lsu_busy[SRIO_LSU_NUM][4];
+
+#define XFER_TIMEOUT_TICKS	((uint64_t)srio_xfer_policy.timeoutUs * CPU_FREQ_MHZ)
+
+/*********************** lsu_wait_free ********************
+* Wait for a free LSU shadow register, at most the policy timeout
+****************************************************/
+static int	lsu_wait_free(uint8_t lsu, uint8_t port)
+{
+	uint64_t	tEnd;
+	uint32_t	spin = 0;
+
+	if(CSL_SRIO_IsLSUFull (hSrio, lsu) == 0)
+		return SRIO_CC_OK;
+
+	tEnd = CSL_tscRead() + XFER_TIMEOUT_TICKS;
+	while (CSL_SRIO_IsLSUFull (hSrio, lsu) != 0) {
+		if(CSL_tscRead() > tEnd)
+			return SRIO_CC_SW_TIMEOUT;
+		if((++spin % SRIO_LINK_CHECK_SPINS) != 0) continue;
+		cmd_idle_wait();
+		if(srio_link_ok(port) == 0)
+			return SRIO_CC_LINK_DOWN;
+	}
+	return SRIO_CC_OK;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Set the priority and CRF of the transaction from the class configuration.
+ */
+void	srio_xfer_class(SrioXfer *x, int cls)
+{
+	if(cls < 0 || cls >= SRIO_CLASS_NUM) cls = SRIO_CLASS_BULK;
+	x->priority = srio_class_cfg[cls].priority;
+	x->crf      = srio_class_cfg[cls].crf;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Select the LSU for the next transaction of the class. The LSUs of
+ *      the class are used round robin, skipping the LSUs without free
+ *      shadow registers. So bulk transfers never occupy control LSUs.
+ *
+ *  @retval
+ *      LSU number
+ */
+uint8_t	srio_lsu_select(int cls)
+{
+	static uint8_t	next[SRIO_CLASS_NUM] = { 0, 0 };
+	uint8_t			mask, lsu;
+	int				i;
+
+	if(cls < 0 || cls >= SRIO_CLASS_NUM) cls = SRIO_CLASS_BULK;
+	mask = srio_class_cfg[cls].lsuMask;
+	if(mask == 0) mask = 0xFF;
+
+	for(i=0; i<SRIO_LSU_NUM; i++) {
+		lsu = (next[cls] + i) % SRIO_LSU_NUM;
+		if(((mask >> lsu) & 1) == 0) continue;
+		if(CSL_SRIO_IsLSUFull (hSrio, lsu) == 0) break;
+	}
+	if(i == SRIO_LSU_NUM) {
+		/* All LSUs of class are full - take next in turn and wait there */
+		for(i=0; i<SRIO_LSU_NUM; i++) {
+			lsu = (next[cls] + i) % SRIO_LSU_NUM;
+			if((mask >> lsu) & 1) break;
+		}
+	}
+	next[cls] = (lsu + 1) % SRIO_LSU_NUM;
+
+	return lsu;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Program the LSU with the transaction and start it.
+ *      The function does not wait for the completion.
+ *
+ *  @param[in]  lsu
+ *      LSU number (0..7).
+ *  @param[in]  x
+ *      Transaction description.
+ *  @param[out] op
+ *      Transaction in progress, used by srio_xfer_done()/srio_xfer_wait().
+ *
+ *  @retval
+ *      Success - SRIO_CC_OK
+ *  @retval
+ *      Error   - SRIO_CC_SW_TIMEOUT (no free LSU shadow register)
+ *  @retval
+ *      Error   - SRIO_CC_LINK_DOWN (output port is down)
+ */
+int	srio_xfer_issue(uint8_t lsu, const SrioXfer *x, SrioOp *op)
+{
+	SrioXfer	routed;
+	int			cc;
+
+	if(srio_route_num) {
+		routed = *x;
+		srio_route_apply(&routed);
+		x = &routed;
+	}
+
+	if(srio_link_ok(x->outPort) == 0)
+		return SRIO_CC_LINK_DOWN;
+
+	/* Make sure there is space in the Shadow registers to write*/
+	if( (cc=lsu_wait_free(lsu, x->outPort)) != SRIO_CC_OK)
+		return cc;
+
+	/* Get the LSU Context and Transaction Information */
+	CSL_SRIO_GetLSUContextTransaction (hSrio, lsu, &op->context, &op->transId);
+
+	CSL_SRIO_SetLSUReg0 (hSrio, lsu, x->remoteAdrHi); // rapidio MSB
+	CSL_SRIO_SetLSUReg1 (hSrio, lsu, x->remoteAdr);
+	CSL_SRIO_SetLSUReg2 (hSrio, lsu, x->localAdr);
+	CSL_SRIO_SetLSUReg3 (hSrio, lsu, x->size, x->doorbell);
+	CSL_SRIO_SetLSUReg4 (hSrio, lsu,
+		x->destId,	// destid
+		0,      // src id map = 0, using RIO_DEVICEID_REG0
+		x->idSize,	// id size = 1 for 16bit device IDs
+		x->outPort,	// outport id
+		SRIO_LSU_PRIO(x->priority, x->crf),	// priority and CRF
+		x->xambs,	// extended address MSBs
+		0,      // suppress good interrupt = 0 (don't care about interrupts)
+		0);     // interrupt request = 0
+	op->tscIssue = CSL_tscRead();
+	CSL_SRIO_SetLSUReg5 (hSrio, lsu,
+		x->ttype,
+		x->ftype,
+		x->hopCount,
+		x->doorbellInfo);
+
+	op->xfer = *x;
+	op->lsu  = lsu;
+	srio_port_bytes[x->outPort] += x->size;
+	srio_lsu_busy[lsu][x->outPort]++;
+
+	srio_trace_rec(TRC_EV_ISSUE, lsu, x->destId, x->remoteAdr, x->size,
+				   (x->ftype << 4) | x->ttype, 0, op->transId, 0);
+
+	return SRIO_CC_OK;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Pack the constant fields of the transfer into the LSU_Reg3..5 words
+ *      once, for srio_desc_issue(). If the route prefers SWRITE, an NWRITE
+ *      gets the SWRITE form of LSU_Reg5 too; the request alignment selects
+ *      one of them at issue.
+ *
+ *  @param[out] d
+ *      Descriptor.
+ *  @param[in]  x
+ *      Transaction description, remoteAdr/localAdr/size are given per issue.
+ */
+void	srio_desc_build(SrioDesc *d, const SrioXfer *x)
+{
+	int		swrite = x->ftype == SRIO_FTYPE_NWRITE && x->ttype == SRIO_TTYPE_NWRITE &&
+					 srio_route_swrite(x->destId);
+
+	d->xfer = *x;
+	srio_route_apply(&d->xfer);
+	if(swrite) {					// SWRITE or not is chosen per request
+		d->xfer.ftype = x->ftype;
+		d->xfer.ttype = x->ttype;
+	}
+	x = &d->xfer;
+
+	d->reg3 = CSL_FMK(SRIO_RIO_LSU_REG3_DRBLL_VALUE, x->doorbell);
+	d->reg4 = CSL_FMK(SRIO_RIO_LSU_REG4_DESTID, x->destId) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_SRCID_MAP, 0) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_ID_SIZE, x->idSize) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_OUTPORTID, x->outPort) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_PRIORITY, SRIO_LSU_PRIO(x->priority, x->crf)) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_XAMBS, x->xambs) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_SUP_GINT, 0) |
+			  CSL_FMK(SRIO_RIO_LSU_REG4_INT_REQ, 0);
+	d->reg5 = CSL_FMK(SRIO_RIO_LSU_REG5_DRBLL_INFO, x->doorbellInfo) |
+			  CSL_FMK(SRIO_RIO_LSU_REG5_HOP_COUNT, x->hopCount) |
+			  CSL_FMK(SRIO_RIO_LSU_REG5_FTYPE, x->ftype) |
+			  CSL_FMK(SRIO_RIO_LSU_REG5_TTYPE, x->ttype);
+	d->reg5Sw = d->reg5;
+	if(swrite)
+		d->reg5Sw = CSL_FMK(SRIO_RIO_LSU_REG5_DRBLL_INFO, x->doorbellInfo) |
+					CSL_FMK(SRIO_RIO_LSU_REG5_HOP_COUNT, x->hopCount) |
+					CSL_FMK(SRIO_RIO_LSU_REG5_FTYPE, SRIO_FTYPE_SWRITE) |
+					CSL_FMK(SRIO_RIO_LSU_REG5_TTYPE, 0);
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Issue the transfer of the precomputed descriptor: plain stores of
+ *      the LSU registers, no field packing. The output port is checked
+ *      only while waiting for a free shadow register.
+ *
+ *  @param[in]  lsu
+ *      LSU number (0..7).
+ *  @param[in]  d
+ *      Descriptor (see srio_desc_build()).
+ *  @param[in]  remoteAdr, localAdr, size
+ *      Per transfer fields.
+ *  @param[out] op
+ *      Transaction in progress.
+ *
+ *  @retval
+ *      SRIO_CC_OK, SRIO_CC_SW_TIMEOUT or SRIO_CC_LINK_DOWN
+ */
+int	srio_desc_issue(uint8_t lsu, const SrioDesc *d, uint32_t remoteAdr, uint32_t localAdr,
+					uint32_t size, SrioOp *op)
+{
+	CSL_SrioRegs	*regs = hSrio;
+	uint32_t		reg5 = ((remoteAdr | localAdr | size) & 7) ? d->reg5 : d->reg5Sw;
+	int				cc;
+
+	if( (cc=lsu_wait_free(lsu, d->xfer.outPort)) != SRIO_CC_OK)
+		return cc;
+
+	CSL_SRIO_GetLSUContextTransaction (hSrio, lsu, &op->context, &op->transId);
+
+	regs->LSU_CMD[lsu].RIO_LSU_REG0 = d->xfer.remoteAdrHi;
+	regs->LSU_CMD[lsu].RIO_LSU_REG1 = remoteAdr;
+	regs->LSU_CMD[lsu].RIO_LSU_REG2 = localAdr;
+	regs->LSU_CMD[lsu].RIO_LSU_REG3 = CSL_FMK(SRIO_RIO_LSU_REG3_BYTE_COUNT, size) | d->reg3;
+	regs->LSU_CMD[lsu].RIO_LSU_REG4 = d->reg4;
+	op->tscIssue = CSL_tscRead();
+	regs->LSU_CMD[lsu].RIO_LSU_REG5 = reg5;		/* starts the transfer */
+
+	op->xfer		   = d->xfer;
+	op->xfer.remoteAdr = remoteAdr;
+	op->xfer.localAdr  = localAdr;
+	op->xfer.size	   = size;
+	if(reg5 != d->reg5) {
+		op->xfer.ftype = SRIO_FTYPE_SWRITE;
+		op->xfer.ttype = 0;
+	}
+	op->lsu			   = lsu;
+	srio_port_bytes[d->xfer.outPort] += size;
+	srio_lsu_busy[lsu][d->xfer.outPort]++;
+
+	srio_trace_rec(TRC_EV_ISSUE, lsu, d->xfer.destId, remoteAdr, size,
+				   (op->xfer.ftype << 4) | op->xfer.ttype, 0, op->transId, 0);
+
+	return SRIO_CC_OK;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Check the completion of the transaction started by srio_xfer_issue().
+ *
+ *  @param[in]  op
+ *      Transaction in progress.
+ *  @param[out] cc
+ *      LSU completion code (valid when the transaction is done).
+ *
+ *  @retval
+ *      1 - transaction is done
+ *  @retval
+ *      0 - transaction is in progress
+ */
+int	srio_xfer_done(SrioOp *op, uint8_t *cc)
+{
+	uint8_t		compCode;
+	uint8_t		contextBit;
+
+	CSL_SRIO_GetLSUCompletionCode (hSrio, op->lsu, op->transId, &compCode, &contextBit);
+	if (contextBit != op->context)
+		return 0;
+
+	*cc = compCode;
+	if(srio_lsu_busy[op->lsu][op->xfer.outPort])
+		srio_lsu_busy[op->lsu][op->xfer.outPort]--;
+	srio_trace_rec(TRC_EV_DONE, op->lsu, op->xfer.destId, op->xfer.remoteAdr, op->xfer.size,
+				   (op->xfer.ftype << 4) | op->xfer.ttype, compCode, op->transId,
+				   (uint32_t)(CSL_tscRead() - op->tscIssue));
+	return 1;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Check if this core has requests to other ports than the given one
+ *      on the LSU. A kill takes all the requests of the core on the LSU,
+ *      so such an LSU must not be killed for a failure of the port.
+ *
+ *  @retval
+ *      1 - LSU is shared with other ports, 0 - it is not
+ */
+int	srio_lsu_shared(uint8_t lsu, uint8_t port)
+{
+	uint8_t		p;
+
+	for(p=0; p<4; p++)
+		if(p != port && srio_lsu_busy[lsu][p]) return 1;
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Give up the transaction. If its LSU has no requests of this core to
+ *      other ports, the LSU is killed, so a late completion can't write
+ *      into a reused buffer and the LSU is free for the next transaction.
+ *      On an LSU shared with healthy ports the request is left to the
+ *      LSU's own response timeout and only dropped from the count.
+ */
+void	srio_xfer_abort(SrioOp *op)
+{
+	uint16_t	*busy = &srio_lsu_busy[op->lsu][op->xfer.outPort];
+
+	if(srio_lsu_shared(op->lsu, op->xfer.outPort) == 0) {
+		CSL_SRIO_KillLSUTransaction (hSrio, op->lsu, DNUM);
+		*busy = 0;
+	}
+	else if(*busy)
+		(*busy)--;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Wait for the completion of the transaction started by srio_xfer_issue().
+ *      If the link fails during the wait, the LSU requests on the port are
+ *      flushed and the transaction fails with SRIO_CC_LINK_DOWN. If there is
+ *      no completion within the policy timeout, the transaction is aborted
+ *      (see srio_xfer_abort()).
+ *
+ *  @retval
+ *      LSU completion code, SRIO_CC_SW_TIMEOUT or SRIO_CC_LINK_DOWN
+ */
+int	srio_xfer_wait(SrioOp *op)
+{
+	uint64_t	tEnd = op->tscIssue + XFER_TIMEOUT_TICKS;
+	uint32_t	spin = 0;
+	uint8_t		cc;
+
+	while (srio_xfer_done(op, &cc) == 0) {
+		++spin;
+		if(CSL_tscRead() > tEnd) {
+			srio_xfer_abort(op);
+			cc = SRIO_CC_SW_TIMEOUT;
+		}
+		else if((spin % SRIO_LINK_CHECK_SPINS) != 0)
+			continue;
+		else {
+			cmd_idle_wait();
+			if(srio_link_ok(op->xfer.outPort)) continue;
+			srio_lsu_flush(op->xfer.outPort);
+			srio_xfer_abort(op);
+			cc = SRIO_CC_LINK_DOWN;
+		}
+
+		srio_trace_rec(TRC_EV_DONE, op->lsu, op->xfer.destId, op->xfer.remoteAdr, op->xfer.size,
+					   (op->xfer.ftype << 4) | op->xfer.ttype, cc, op->transId,
+					   (uint32_t)(CSL_tscRead() - op->tscIssue));
+		return cc;
+	}
+	return cc;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Completion codes worth a retry: congestion, RETRY response and
+ *      timeouts. Error responses, invalid requests, DMA errors and link
+ *      failures fail at once.
+ *
+ *  @retval
+ *      1 - transient, 0 - hard error
+ */
+int	srio_cc_transient(int cc)
+{
+	switch(cc) {
+	case SRIO_CC_TIMEOUT:
+	case SRIO_CC_XOFF:
+	case SRIO_CC_RETRY:
+	case SRIO_CC_NOCREDIT:
+	case SRIO_CC_SW_TIMEOUT:
+		return 1;
+	}
+	return 0;
+}
+
+/*********************** xfer_backoff ********************
+* Busy wait between the retries
+****************************************************/
+static void	xfer_backoff(uint32_t us)
+{
+	uint64_t	t0 = CSL_tscRead();
+
+	while(CSL_tscRead() - t0 < (uint64_t)us * CPU_FREQ_MHZ)
+		;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Blocking transaction: issue and wait for the completion. Transient
+ *      failures (see srio_cc_transient()) are retried up to the policy
+ *      retry count, the delay between the retries starts at backoffUs and
+ *      doubles up to backoffMaxUs.
+ *
+ *  @retval
+ *      LSU completion code, SRIO_CC_SW_TIMEOUT or SRIO_CC_LINK_DOWN
+ */
+int	srio_xfer(uint8_t lsu, const SrioXfer *x)
+{
+	const SrioXferPolicy	*p = &srio_xfer_policy;
+	SrioOp		op;
+	uint32_t	retry, backoff = p->backoffUs;
+	int			cc;
+
+	for(retry=0; ; retry++) {
+		if( (cc=srio_xfer_issue(lsu, x, &op)) == SRIO_CC_OK)
+			cc = srio_xfer_wait(&op);
+		if(cc == SRIO_CC_OK || srio_cc_transient(cc) == 0 || retry >= p->retries)
+			break;
+
+		srio_xfer_retried++;
+		xfer_backoff(backoff);
+		backoff = (backoff * 2 > p->backoffMaxUs) ? p->backoffMaxUs : backoff * 2;
+	}
+	if(cc != SRIO_CC_OK) srio_xfer_failed++;
+	return cc;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Get the ports that can carry the traffic to the destination: ports
+ *      formed by the lane mode, operational and routed to the destination.
+ *
+ *  @retval
+ *      Ports mask (bit N - port N)
+ */
+uint8_t	srio_port_eligible(uint16_t destId)
+{
+	uint8_t		mask = srio_port_mask(lane_mode);
+	uint8_t		port, eligible = 0;
+	SrioRoute	*r = srio_route_find(destId);
+
+	if(r && r->outPort != SRIO_ROUTE_DEFAULT)
+		mask &= 1 << r->outPort;
+	for(port=0; port<4; port++) {
+		if(((mask >> port) & 1) == 0) continue;
+		if(srio_port_dest[port] != SRIO_PORT_DEST_ANY && srio_port_dest[port] != destId) continue;
+		if(srio_link_ok(port) == 0) continue;
+		eligible |= 1 << port;
+	}
+	return eligible;
+}
+
+/*********************** port_after ********************
+* Next port of mask after port (round robin)
+****************************************************/
+static uint8_t	port_after(uint8_t mask, uint8_t port)
+{
+	int		i;
+
+	for(i=1; i<=4; i++)
+		if((mask >> ((port + i) & 3)) & 1)
+			return (port + i) & 3;
+	return 0;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Select the output port for the next independent transaction to the
+ *      destination, round robin over the eligible ports.
+ *
+ *  @retval
+ *      Port number (0 if no port is eligible)
+ */
+uint8_t	srio_port_next(uint16_t destId)
+{
+	static uint8_t	last = 3;
+
+	last = port_after(srio_port_eligible(destId), last);
+	return last;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Block transfer striped across the eligible ports. The block is split
+ *      into chunk bytes LSU requests which are issued round robin over the
+ *      ports on the LSUs of the class, with up to SRIO_STRIPE_WINDOW requests
+ *      in progress.
+ *
+ *  @param[in]  x
+ *      Transaction description (NWRITE/NREAD), size is the block size.
+ *  @param[in]  cls
+ *      Priority class.
+ *  @param[in]  chunk
+ *      Bytes per LSU request (0 - SRIO_STRIPE_CHUNK).
+ *
+ *  @retval
+ *      SRIO_CC_OK or the first error code
+ */
+int	srio_xfer_stripe(const SrioXfer *x, int cls, uint32_t chunk)
+{
+	SrioOp		ops[SRIO_STRIPE_WINDOW];
+	SrioDesc	desc[4];		/* per port */
+	SrioXfer	part = *x;
+	uint8_t		mask = srio_port_eligible(x->destId);
+	uint8_t		port = 3;
+	uint32_t	done = 0, size;
+	int			first = 0, num = 0;
+	int			cc, ret = SRIO_CC_OK;
+
+	if(mask == 0)
+		return SRIO_CC_LINK_DOWN;
+	if(chunk == 0 || chunk > SRIO_LSU_MAX_BYTES)
+		chunk = SRIO_STRIPE_CHUNK;
+	for(port=0; port<4; port++) {
+		if(((mask >> port) & 1) == 0) continue;
+		part.outPort = port;
+		srio_desc_build(&desc[port], &part);
+	}
+	port = 3;
+
+	while(done < x->size) {
+		if(num == SRIO_STRIPE_WINDOW) {
+			cc = srio_xfer_wait(&ops[first]);
+			first = (first + 1) % SRIO_STRIPE_WINDOW;
+			num--;
+			if(cc != SRIO_CC_OK) { ret = cc; break; }
+		}
+
+		port = port_after(mask, port);
+		size = (x->size - done < chunk) ? x->size - done : chunk;
+
+		cc = srio_desc_issue(srio_lsu_select(cls), &desc[port], x->remoteAdr + done, x->localAdr + done,
+							 size, &ops[(first + num) % SRIO_STRIPE_WINDOW]);
+		if(cc != SRIO_CC_OK) { ret = cc; break; }
+		num++;
+		done += size;
+	}
+
+	while(num) {
+		cc = srio_xfer_wait(&ops[first]);
+		if(cc != SRIO_CC_OK && ret == SRIO_CC_OK) ret = cc;
+		first = (first + 1) % SRIO_STRIPE_WINDOW;
+		num--;
+	}
+	return ret;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Write the same block to several destinations. The block is split
+ *      into chunk bytes LSU requests; request n goes to every destination
+ *      before request n+1, so all destinations progress together on all
+ *      LSUs of the class with up to SRIO_STRIPE_WINDOW requests in progress.
+ *      A destination is dropped after its first error.
+ *
+ *  @param[in]  x
+ *      Transaction description (NWRITE/NWRITE_R/SWRITE), destId is ignored.
+ *  @param[in]  ids, num
+ *      Destination IDs (up to SRIO_BCAST_MAX).
+ *  @param[in]  cls
+ *      Priority class.
+ *  @param[in]  chunk
+ *      Bytes per LSU request (0 - SRIO_STRIPE_CHUNK).
+ *  @param[out]  cc
+ *      Completion code per destination.
+ *
+ *  @retval
+ *      Number of destinations with error
+ */
+int	srio_xfer_bcast(const SrioXfer *x, const uint16_t *ids, int num, int cls, uint32_t chunk, int *cc)
+{
+	SrioOp		ops[SRIO_STRIPE_WINDOW];
+	uint8_t		opDest[SRIO_STRIPE_WINDOW];
+	SrioXfer	part = *x;
+	uint32_t	done = 0;
+	int			first = 0, inProg = 0;
+	int			i, ret, errors = 0;
+
+	if(num > SRIO_BCAST_MAX) num = SRIO_BCAST_MAX;
+	if(chunk == 0 || chunk > SRIO_LSU_MAX_BYTES)
+		chunk = SRIO_STRIPE_CHUNK;
+	for(i=0; i<num; i++)
+		cc[i] = srio_port_eligible(ids[i]) ? SRIO_CC_OK : SRIO_CC_LINK_DOWN;
+
+	for(done=0; done < x->size; done += part.size) {
+		part.remoteAdr = x->remoteAdr + done;
+		part.localAdr  = x->localAdr + done;
+		part.size      = (x->size - done < chunk) ? x->size - done : chunk;
+
+		for(i=0; i<num; i++) {
+			if(cc[i] != SRIO_CC_OK) continue;
+			if(inProg == SRIO_STRIPE_WINDOW) {
+				ret = srio_xfer_wait(&ops[first]);
+				if(ret != SRIO_CC_OK && cc[opDest[first]] == SRIO_CC_OK) cc[opDest[first]] = ret;
+				first = (first + 1) % SRIO_STRIPE_WINDOW;
+				inProg--;
+			}
+			part.destId  = ids[i];
+			part.outPort = srio_port_next(ids[i]);
+			ret = srio_xfer_issue(srio_lsu_select(cls), &part, &ops[(first + inProg) % SRIO_STRIPE_WINDOW]);
+			if(ret != SRIO_CC_OK) { cc[i] = ret; continue; }
+			opDest[(first + inProg) % SRIO_STRIPE_WINDOW] = i;
+			inProg++;
+		}
+	}
+
+	while(inProg) {
+		ret = srio_xfer_wait(&ops[first]);
+		if(ret != SRIO_CC_OK && cc[opDest[first]] == SRIO_CC_OK) cc[opDest[first]] = ret;
+		first = (first + 1) % SRIO_STRIPE_WINDOW;
+		inProg--;
+	}
+
+	for(i=0; i<num; i++)
+		if(cc[i] != SRIO_CC_OK) errors++;
+	return errors;
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Post a message into the memory of other device: NWRITE size bytes
+ *      of the message, then its sequence word with a doorbell, through one
+ *      LSU and port, so the sequence word can't pass the message.
+ *
+ *  @param[in]  remote
+ *      Message address in the destination memory.
+ *  @param[in]  msg, size
+ *      Own copy of the message and bytes before the sequence word.
+ *  @param[in]  seqOfs
+ *      Offset of the sequence word in the message (>= size).
+ *  @param[in]  doorbellInfo
+ *      Doorbell info sent with the sequence word.
+ *
+ *  @retval
+ *      SRIO_CC_xxx
+ */
+int	srio_xfer_post(uint16_t destId, uint32_t remote, const void *msg, uint32_t size,
+				   uint32_t seqOfs, uint16_t doorbellInfo)
+{
+	SrioXfer	x;
+	SrioOp		op[2];
+	uint8_t		lsu;
+	int			cc, cc1;
+
+	CACHE_wbL1d((void *)msg, seqOfs + 4, CACHE_WAIT);
+
+	memset(&x, 0, sizeof(x));
+	x.destId	= destId;
+	x.idSize	= id_size;
+	x.ftype		= SRIO_FTYPE_NWRITE;
+	x.ttype		= SRIO_TTYPE_NWRITE;
+	x.localAdr	= srio_global_adr((uint32_t)msg);
+	x.remoteAdr	= remote;
+	x.size		= size;
+	srio_xfer_class(&x, SRIO_CLASS_CTRL);
+	x.outPort	= srio_port_next(destId);
+
+	lsu = srio_lsu_select(SRIO_CLASS_CTRL);
+	cc = srio_xfer_issue(lsu, &x, &op[0]);
+	if(cc != SRIO_CC_OK) return cc;
+
+	x.localAdr	+= seqOfs;
+	x.remoteAdr	+= seqOfs;
+	x.size		 = 4;
+	x.doorbell	 = 1;
+	x.doorbellInfo = doorbellInfo;
+	cc  = srio_xfer_issue(lsu, &x, &op[1]);
+	cc1 = srio_xfer_wait(&op[0]);
+	if(cc == SRIO_CC_OK) cc = srio_xfer_wait(&op[1]);
+	return (cc1 != SRIO_CC_OK) ? cc1 : cc;
+}
+
+/*********************** srio_global_adr ********************
+* Convert local L1D/L2 address of this core to the global address
+* (SRIO DMA uses global addresses only)
+****************************************************/
+uint32_t	srio_global_adr(uint32_t adr)
+{
+	if((adr & 0xFF000000) == 0)
+		return adr | ((0x10 + DNUM) << 24);
+	return adr;
+}
+
+/*********************** srio_cc_str ********************
+****************************************************/
+const char	*srio_cc_str(int cc)
+{
+	switch(cc) {
+	case SRIO_CC_OK:			return "OK";
+	case SRIO_CC_TIMEOUT:		return "TIMEOUT";
+	case SRIO_CC_XOFF:			return "XOFF";
+	case SRIO_CC_ERROR:			return "ERROR RESPONSE";
+	case SRIO_CC_INVALID:		return "INVALID REQUEST";
+	case SRIO_CC_DMA:			return "DMA ERROR";
+	case SRIO_CC_RETRY:			return "RETRY";
+	case SRIO_CC_NOCREDIT:		return "NO CREDIT";
+	case SRIO_CC_SW_TIMEOUT:	return "SW TIMEOUT";
+	case SRIO_CC_LINK_DOWN:		return "LINK DOWN";
+	}
+	return "UNKNOWN";
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Parse the hex RapidIO address of the given size and set the address
+ *      fields of the transaction:
+ *      - 32-bit: bits 31:0 (LSU_Reg1)
+ *      - 34-bit: bits 33:32 in xambs
+ *      - 50-bit: bits 47:32 in LSU_Reg0, bits 49:48 in xambs
+ *      - 66-bit: bits 63:32 in LSU_Reg0, bits 65:64 in xambs
+ *
+ *  @retval
+ *      Success - 0
+ *  @retval
+ *      Error   - <0 (bad hex number or address is out of the address size)
+ */
+int	srio_addr_parse(const char *str, int bits, SrioXfer *x)
+{
+	uint32_t	w[3] = { 0, 0, 0 };		// bits 31:0, 63:32, 65:64
+	int			n, d;
+	char		ch;
+
+	if(str[0] == '0' && (str[1] == 'x' || str[1] == 'X')) str += 2;
+	for(n=0; (ch=str[n]) != 0; n++) {
+		if(ch >= '0' && ch <= '9')		d = ch - '0';
+		else if(ch >= 'a' && ch <= 'f')	d = ch - 'a' + 10;
+		else if(ch >= 'A' && ch <= 'F')	d = ch - 'A' + 10;
+		else return -1;
+		if(w[2] & 0xF0000000) return -1;	// more than 96 bits
+		w[2] = (w[2] << 4) | (w[1] >> 28);
+		w[1] = (w[1] << 4) | (w[0] >> 28);
+		w[0] = (w[0] << 4) | d;
+	}
+	if(n == 0) return -1;
+
+	x->remoteAdr   = w[0];
+	x->remoteAdrHi = 0;
+	x->xambs       = 0;
+	switch(bits) {
+	case SRIO_ADDR_32:
+		if(w[1] || w[2]) return -1;
+		break;
+	case SRIO_ADDR_34:
+		if((w[1] & ~0x3) || w[2]) return -1;
+		x->xambs = w[1];
+		break;
+	case SRIO_ADDR_50:
+		if((w[1] & ~0x3FFFF) || w[2]) return -1;
+		x->remoteAdrHi = w[1] & 0xFFFF;
+		x->xambs       = w[1] >> 16;
+		break;
+	case SRIO_ADDR_66:
+		if(w[2] & ~0x3) return -1;
+		x->remoteAdrHi = w[1];
+		x->xambs       = w[2];
+		break;
+	default:
+		return -1;
+	}
+	return 0;
+}
+
+/*********************** srio_addr_str ********************
+* Format the RapidIO address of the transaction
+****************************************************/
+char	*srio_addr_str(const SrioXfer *x, char *buf)
+{
+	if(x->remoteAdrHi == 0 && x->xambs == 0)
+		sprintf(buf, "0x%08lX", x->remoteAdr);
+	else if(x->remoteAdrHi == 0)
+		sprintf(buf, "0x%X_%08lX", x->xambs, x->remoteAdr);
+	else
+		sprintf(buf, "0x%X_%08lX_%08lX", x->xambs, x->remoteAdrHi, x->remoteAdr);
+	return buf;
+}
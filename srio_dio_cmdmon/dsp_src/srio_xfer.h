@@ -0,0 +1,161 @@
+/*
+ *  srio_xfer.h
+ *
+ *  DirectIO (LSU) transfer layer of the SRIO Command Monitor.
+ */
+#ifndef SRIO_XFER_H_
+#define SRIO_XFER_H_
+
+#include <stdint.h>
+
+/* RapidIO packet types (ftype / ttype) used by the monitor */
+#define SRIO_FTYPE_NREAD		2
+#define SRIO_TTYPE_NREAD		4
+#define SRIO_FTYPE_NWRITE		5
+#define SRIO_TTYPE_NWRITE		4
+#define SRIO_TTYPE_NWRITE_R		5
+#define SRIO_FTYPE_SWRITE		6
+#define SRIO_FTYPE_MAINT		8
+#define SRIO_TTYPE_MAINT_RD		0
+#define SRIO_TTYPE_MAINT_WR		1
+#define SRIO_FTYPE_DOORBELL		10
+
+/* LSU completion codes (LSU_STAT_REG) */
+#define SRIO_CC_OK				0	/* transaction complete, no errors */
+#define SRIO_CC_TIMEOUT			1	/* timeout on non-posted transaction */
+#define SRIO_CC_XOFF			2	/* not sent due to flow control blockade */
+#define SRIO_CC_ERROR			3	/* ERROR response or bad response payload */
+#define SRIO_CC_INVALID			4	/* unsupported type or invalid programming */
+#define SRIO_CC_DMA				5	/* DMA data transfer error */
+#define SRIO_CC_RETRY			6	/* RETRY doorbell response */
+#define SRIO_CC_NOCREDIT		7	/* no outbound credit at given priority */
+/* Software codes (not reported by LSU) */
+#define SRIO_CC_SW_TIMEOUT		8	/* no completion seen in time */
+#define SRIO_CC_LINK_DOWN		9	/* output port is down or error-stopped */
+
+#define SRIO_LSU_NUM			8				/* LSUs in KeyStone SRIO */
+#define SRIO_LSU_MAX_BYTES		(1024*1024)		/* max byte count of one LSU request */
+
+/* LSU_Reg4 ID size */
+#define SRIO_ID_8BIT			0	/* small transport system (8-bit IDs) */
+#define SRIO_ID_16BIT			1	/* large transport system (16-bit IDs) */
+
+/* RapidIO address size (bits) */
+#define SRIO_ADDR_32			32	/* 32-bit address, xambs = 0 */
+#define SRIO_ADDR_34			34
+#define SRIO_ADDR_50			50
+#define SRIO_ADDR_66			66
+
+/* Default transaction policy (see srio_xfer()) */
+#define SRIO_XFER_TIMEOUT_US	10000	/* max wait for LSU shadow register or completion */
+#define SRIO_XFER_RETRIES		4		/* retries of transient failures */
+#define SRIO_BACKOFF_US			10		/* first retry delay, doubled every retry */
+#define SRIO_BACKOFF_MAX_US		1000
+
+/* Outbound priority classes */
+#define SRIO_CLASS_CTRL			0	/* latency critical control traffic */
+#define SRIO_CLASS_BULK			1	/* background bulk traffic */
+#define SRIO_CLASS_NUM			2
+
+/* Striping of block transfers across the ports */
+#define SRIO_STRIPE_CHUNK		(64*1024)		/* default bytes per LSU request */
+#define SRIO_STRIPE_WINDOW		SRIO_LSU_NUM	/* max outstanding LSU requests */
+
+/* Max destinations of srio_xfer_bcast() */
+#define SRIO_BCAST_MAX			32
+
+/* srio_port_dest[] value: the port reaches every destination */
+#define SRIO_PORT_DEST_ANY		0xFFFFFFFF
+
+/* Max request priority; priority 3 is left for responses (NREAD, MAINT) */
+#define SRIO_PRIO_MAX			2
+
+/** One DirectIO transaction description */
+typedef struct
+{
+	uint16_t	destId;			/* destination device ID */
+	uint8_t		idSize;			/* SRIO_ID_8BIT or SRIO_ID_16BIT */
+	uint8_t		ftype;			/* RapidIO ftype */
+	uint8_t		ttype;			/* RapidIO ttype */
+	uint8_t		hopCount;		/* hop count for maintenance packets */
+	uint8_t		outPort;		/* output port */
+	uint32_t	remoteAdr;		/* RapidIO address bits 31:0 (or config offset) */
+	uint32_t	remoteAdrHi;	/* RapidIO address MSB (50/66-bit addressing) */
+	uint8_t		xambs;			/* extended address MSBs (2 bits above address) */
+	uint32_t	localAdr;		/* DSP (global) address of data */
+	uint32_t	size;			/* byte count */
+	uint8_t		doorbell;		/* 1 - send doorbell after NWRITE */
+	uint16_t	doorbellInfo;	/* doorbell info field */
+	uint8_t		priority;		/* request priority 0..SRIO_PRIO_MAX */
+	uint8_t		crf;			/* critical request flow bit */
+} SrioXfer;
+
+/** Outbound priority class configuration */
+typedef struct
+{
+	uint8_t		priority;		/* request priority 0..SRIO_PRIO_MAX */
+	uint8_t		crf;			/* critical request flow bit */
+	uint8_t		lsuMask;		/* LSUs reserved for the class */
+} SrioClassCfg;
+
+/** Transaction policy: timeouts and retry of transient failures */
+typedef struct
+{
+	uint32_t	timeoutUs;		/* max wait for LSU shadow register or completion */
+	uint32_t	retries;		/* max retries of a transient failure */
+	uint32_t	backoffUs;		/* first retry delay */
+	uint32_t	backoffMaxUs;	/* retry delay limit */
+} SrioXferPolicy;
+
+extern SrioClassCfg	srio_class_cfg[SRIO_CLASS_NUM];
+extern SrioXferPolicy	srio_xfer_policy;
+extern uint32_t		srio_xfer_retried;
+extern uint32_t		srio_xfer_failed;
+extern uint16_t		srio_lsu_busy[SRIO_LSU_NUM][4];
+extern uint32_t		srio_port_dest[4];
+extern uint32_t		srio_port_bytes[4];
+
+/** Transaction in progress on an LSU */
+typedef struct
+{
+	SrioXfer	xfer;
+	uint8_t		lsu;
+	uint8_t		context;
+	uint8_t		transId;
+	uint64_t	tscIssue;		/* TSC at issue time */
+} SrioOp;
+
+/** Precomputed LSU descriptor: the constant LSU_Reg3..5 bits of a transfer */
+typedef struct
+{
+	uint32_t	reg3;			/* doorbell valid bit */
+	uint32_t	reg4;			/* destId, idSize, outPort, priority, xambs */
+	uint32_t	reg5;			/* ftype, ttype, hop count, doorbell info */
+	uint32_t	reg5Sw;			/* reg5 of 8 bytes aligned requests (SWRITE by route) */
+	SrioXfer	xfer;			/* transfer the descriptor was built from */
+} SrioDesc;
+
+void		srio_xfer_class(SrioXfer *x, int cls);
+uint8_t		srio_lsu_select(int cls);
+int			srio_xfer_issue(uint8_t lsu, const SrioXfer *x, SrioOp *op);
+void		srio_desc_build(SrioDesc *d, const SrioXfer *x);
+int			srio_desc_issue(uint8_t lsu, const SrioDesc *d, uint32_t remoteAdr, uint32_t localAdr,
+							uint32_t size, SrioOp *op);
+int			srio_xfer_done(SrioOp *op, uint8_t *cc);
+int			srio_xfer_wait(SrioOp *op);
+int			srio_lsu_shared(uint8_t lsu, uint8_t port);
+void		srio_xfer_abort(SrioOp *op);
+int			srio_xfer(uint8_t lsu, const SrioXfer *x);
+uint8_t		srio_port_eligible(uint16_t destId);
+uint8_t		srio_port_next(uint16_t destId);
+int			srio_xfer_stripe(const SrioXfer *x, int cls, uint32_t chunk);
+int			srio_xfer_bcast(const SrioXfer *x, const uint16_t *ids, int num, int cls, uint32_t chunk, int *cc);
+int			srio_xfer_post(uint16_t destId, uint32_t remote, const void *msg, uint32_t size,
+						   uint32_t seqOfs, uint16_t doorbellInfo);
+int			srio_cc_transient(int cc);
+const char	*srio_cc_str(int cc);
+uint32_t	srio_global_adr(uint32_t adr);
+int			srio_addr_parse(const char *str, int bits, SrioXfer *x);
+char		*srio_addr_str(const SrioXfer *x, char *buf);
+
+#endif /* SRIO_XFER_H_ */
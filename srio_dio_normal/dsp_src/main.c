@@ -322,8 +322,286 @@ void	print_usage(void)
 	printf("       -m, -M                 -- master mode\n");
 	printf("       -s, -S				  -- slave mode\n");
 	printf("       -b<N>, -B<N>			  -- board id N\n");
+	printf("       -x<M>                  -- ping-pong test, M: p - NWRITE poll, d - NWRITE+doorbell,\n");
+	printf("                                 r - NREAD (m - Type-11 message, not supported)\n");
+	printf("       -n<N>                  -- ping-pong iterations (default 1000)\n");
+	printf("       -z<N>                  -- ping-pong payload bytes, 8..32768 (default 8)\n");
 }
 
+///////////////////////////////////////////////////////////////
+////////// ping-pong latency test /////////////////////////////
+///////////////////////////////////////////////////////////////
+#define CPU_FREQ_MHZ		1000		// TSC ticks per us
+
+/* Ping-pong transaction type (-x option) */
+#define PP_MODE_NONE		0			// one-shot exchange (no ping-pong)
+#define PP_MODE_POLL		1			// NWRITE, receiver polls the sequence word
+#define PP_MODE_DOORBELL	2			// NWRITE followed by doorbell
+#define PP_MODE_NREAD		3			// NREAD request/response from the master
+
+/* Ping-pong buffers (core 0 L2, global address) */
+#define PP_RX_ADR			0x10860000	// written by the partner
+#define PP_TX_ADR			0x10870000	// sent to the partner
+#define PP_MAX_SIZE			0x8000
+
+/* Last word of the payload is the sequence number, previous one is
+ * the turnaround time of the slave in TSC ticks */
+#define PP_SEQ_NONE			0
+#define PP_SEQ_HELLO		0xFFFFFFFF
+
+#define PP_DB_REG			0			// doorbell register 0, bit 0
+#define PP_DB_BIT			0
+
+#define PP_TIMEOUT			1000000000	// 1 s in TSC ticks
+#define PP_HELLO_PERIOD		10000000	// 10 ms in TSC ticks
+#define PP_HIST_SIZE		32			// log2 (ns) buckets
+
+int pp_mode = PP_MODE_NONE;
+int pp_count = 1000;
+int pp_size = 8;
+
+typedef struct
+{
+	uint32_t	hist[PP_HIST_SIZE];
+	uint32_t	min, max, num;
+	uint64_t	sum;
+} PpStat;
+
+/*********************** pp_issue ********************
+* Start the LSU transaction, return the transaction context
+****************************************************/
+static void	pp_issue(int lsu, uint8_t dest_id, uint8_t ftype, uint8_t ttype,
+					 uint32_t remote, uint32_t local, uint32_t size, int doorbell,
+					 uint8_t *context, uint8_t *transId)
+{
+	/* Make sure there is space in the Shadow registers to write*/
+	while (CSL_SRIO_IsLSUFull (hSrio, lsu) != 0);
+
+	CSL_SRIO_GetLSUContextTransaction (hSrio, lsu, context, transId);
+
+	CSL_SRIO_SetLSUReg0 (hSrio, lsu, 0); //no rapidio MSB
+	CSL_SRIO_SetLSUReg1 (hSrio, lsu, remote);
+	CSL_SRIO_SetLSUReg2 (hSrio, lsu, local);
+	CSL_SRIO_SetLSUReg3 (hSrio, lsu, size, doorbell);
+	CSL_SRIO_SetLSUReg4 (hSrio, lsu,
+		dest_id,// destid
+		0,      // src id map = 0, using RIO_DEVICEID_REG0
+		0, 		// id size = 1 for 16bit device IDs
+		0,      // outport id = 0
+		0,      // priority = 0
+		0,      // xambs = 0
+		0,      // suppress good interrupt = 0 (don't care about interrupts)
+		0);     // interrupt request = 0
+	CSL_SRIO_SetLSUReg5 (hSrio, lsu,
+		ttype,
+		ftype,
+		0,  	// hop count = 0,
+		doorbell ? PP_DB_BIT : 0); 	// doorbell info (register 0)
+}
+
+/*********************** pp_lsu_wait ********************
+* Wait for the LSU completion, return completion code or -1 on timeout
+****************************************************/
+static int	pp_lsu_wait(int lsu, uint8_t context, uint8_t transId, uint64_t tscEnd)
+{
+	uint8_t		compCode, contextBit;
+
+	do {
+		CSL_SRIO_GetLSUCompletionCode (hSrio, lsu, transId, &compCode, &contextBit);
+		if (contextBit == context)
+			return compCode;
+	} while (CSL_tscRead() < tscEnd);
+
+	return -1;
+}
+
+/*********************** pp_rx_wait ********************
+* Wait for the packet with sequence number seq in the RX buffer
+****************************************************/
+static int	pp_rx_wait(uint32_t seq, uint64_t tscEnd)
+{
+	volatile uint32_t	*rxSeq = (volatile uint32_t *)(PP_RX_ADR + pp_size - 4);
+	Uint16				pending;
+
+	if(pp_mode == PP_MODE_DOORBELL && seq != PP_SEQ_HELLO) {
+		do {
+			CSL_SRIO_GetDoorbellPendingInterrupt (hSrio, PP_DB_REG, &pending);
+			if (pending & (1 << PP_DB_BIT)) {
+				CSL_SRIO_ClearDoorbellPendingInterrupt (hSrio, PP_DB_REG, 1 << PP_DB_BIT);
+				// doorbell is sent after the NWRITE data is written
+				return (*rxSeq == seq) ? 0 : -2;
+			}
+		} while (CSL_tscRead() < tscEnd);
+		return -1;
+	}
+
+	do {
+		if (*rxSeq == seq)
+			return 0;
+	} while (CSL_tscRead() < tscEnd);
+
+	return -1;
+}
+
+static void	pp_stat_add(PpStat *s, uint32_t ticks)
+{
+	uint32_t	ns = (uint32_t)(((uint64_t)ticks * 1000) / CPU_FREQ_MHZ);
+	int			b = ns ? 31 - _lmbd(1, ns) : 0;		// floor(log2(ns))
+
+	s->hist[b]++;
+	if(s->num == 0 || ns < s->min) s->min = ns;
+	if(ns > s->max) s->max = ns;
+	s->sum += ns;
+	s->num++;
+}
+
+static void	pp_stat_print(const char *name, PpStat *s)
+{
+	int			b;
+	uint32_t	peak = 0;
+
+	if(s->num == 0) {
+		printf("%s: no samples\n", name);
+		return;
+	}
+	printf("%s: min %d ns, avg %d ns, max %d ns (%d samples)\n", name,
+		s->min, (uint32_t)(s->sum / s->num), s->max, s->num);
+
+	for(b=0; b<PP_HIST_SIZE; b++)
+		if(s->hist[b] > peak) peak = s->hist[b];
+	for(b=0; b<PP_HIST_SIZE; b++) {
+		if(s->hist[b] == 0) continue;
+		int		n, bar = (s->hist[b] * 40 + peak - 1) / peak;
+		printf("  %10u..%-10u ns %8d |", 1u << b, (2u << b) - 1, s->hist[b]);
+		for(n=0; n<bar; n++) printf("#");
+		printf("\n");
+	}
+}
+
+/**
+ *  @b Description
+ *  @n
+ *      Round-trip ping-pong latency test between the master and the slave boards.
+ *
+ *      The master sends pp_count packets of pp_size bytes to the RX buffer of
+ *      the slave and waits for each reply in its own RX buffer; the slave sends
+ *      the reply as soon as the packet is received, with its turnaround time.
+ *      The master reports the round-trip and one-way ((round-trip - turnaround) / 2)
+ *      latency histograms. In NREAD mode the master measures the NREAD
+ *      request/response time only and the slave is passive.
+ *
+ *  @param[in]  dest_id
+ *      Device ID of the partner board.
+ *
+ *  @retval
+ *      Success - 0
+ *  @retval
+ *      Error   - <0
+ */
+int32_t	pingpong(uint8_t dest_id)
+{
+	static PpStat		rtt, oneway;
+	volatile uint32_t	*rx = (volatile uint32_t *)PP_RX_ADR;
+	volatile uint32_t	*tx = (volatile uint32_t *)PP_TX_ADR;
+	int					last = pp_size/4 - 1;
+	int					lsu = 0;
+	uint8_t				context, transId;
+	uint64_t			t0, t1, tscEnd;
+	uint32_t			seq, i;
+	int					ret;
+
+	memset(&rtt, 0, sizeof(rtt));
+	memset(&oneway, 0, sizeof(oneway));
+	for(i=0; i<=last; i++) {
+		rx[i] = PP_SEQ_NONE;
+		tx[i] = 0x5A5A0000 | i;
+	}
+
+	printf("PINGPONG: %s, mode %s, %d x %d bytes, partner ID 0x%X\n",
+		master_flag ? "master" : "slave",
+		pp_mode == PP_MODE_POLL ? "NWRITE poll" :
+		(pp_mode == PP_MODE_DOORBELL ? "NWRITE+doorbell" : "NREAD"),
+		pp_count, pp_size, dest_id);
+
+	/* NREAD: request/response time of the master only */
+	if(pp_mode == PP_MODE_NREAD) {
+		if(master_flag == 0) return 0;
+		for(seq=1; seq<=pp_count; seq++) {
+			pp_issue(lsu, dest_id, 2, 4, PP_TX_ADR, PP_RX_ADR, pp_size, 0, &context, &transId);
+			t0 = CSL_tscRead();
+			ret = pp_lsu_wait(lsu, context, transId, t0 + PP_TIMEOUT);
+			t1 = CSL_tscRead();
+			if(ret != 0) {
+				printf("### PINGPONG: NREAD %d failed, completion code %d\n", seq, ret);
+				return -1;
+			}
+			pp_stat_add(&rtt, (uint32_t)(t1 - t0));
+			pp_stat_add(&oneway, (uint32_t)(t1 - t0) / 2);
+		}
+		pp_stat_print("ROUND-TRIP", &rtt);
+		pp_stat_print("ONE-WAY (RTT/2)", &oneway);
+		return 0;
+	}
+
+	CSL_SRIO_ClearDoorbellPendingInterrupt (hSrio, PP_DB_REG, 1 << PP_DB_BIT);
+
+	/* Handshake: master repeats HELLO until the slave answers */
+	if(master_flag) {
+		tx[last] = PP_SEQ_HELLO;
+		tscEnd = CSL_tscRead() + 10ull * PP_TIMEOUT;
+		do {
+			pp_issue(lsu, dest_id, 5, 4, PP_RX_ADR, PP_TX_ADR, pp_size, 0, &context, &transId);
+			if(CSL_tscRead() > tscEnd) {
+				printf("### PINGPONG: no answer from slave\n");
+				return -1;
+			}
+		} while(pp_rx_wait(PP_SEQ_HELLO, CSL_tscRead() + PP_HELLO_PERIOD) != 0);
+	} else {
+		while(pp_rx_wait(PP_SEQ_HELLO, CSL_tscRead() + PP_TIMEOUT) != 0);
+		tx[last] = PP_SEQ_HELLO;
+		pp_issue(lsu, dest_id, 5, 4, PP_RX_ADR, PP_TX_ADR, pp_size, 0, &context, &transId);
+	}
+
+	for(seq=1; seq<=pp_count; seq++) {
+		if(master_flag) {
+			tx[last-1] = 0;
+			tx[last]   = seq;
+			t0 = CSL_tscRead();
+			pp_issue(lsu, dest_id, 5, 4, PP_RX_ADR, PP_TX_ADR, pp_size,
+					 pp_mode == PP_MODE_DOORBELL, &context, &transId);
+			ret = pp_rx_wait(seq, t0 + PP_TIMEOUT);
+			t1 = CSL_tscRead();
+			if(ret != 0) {
+				printf("### PINGPONG: %s on packet %d\n", ret == -1 ? "timeout" : "bad sequence", seq);
+				break;
+			}
+			pp_stat_add(&rtt, (uint32_t)(t1 - t0));
+			pp_stat_add(&oneway, ((uint32_t)(t1 - t0) - rx[last-1]) / 2);
+		} else {
+			ret = pp_rx_wait(seq, CSL_tscRead() + PP_TIMEOUT);
+			t0 = CSL_tscRead();
+			if(ret != 0) {
+				printf("### PINGPONG: %s on packet %d\n", ret == -1 ? "timeout" : "bad sequence", seq);
+				break;
+			}
+			tx[last]   = seq;
+			tx[last-1] = (uint32_t)(CSL_tscRead() - t0);
+			pp_issue(lsu, dest_id, 5, 4, PP_RX_ADR, PP_TX_ADR, pp_size,
+					 pp_mode == PP_MODE_DOORBELL, &context, &transId);
+		}
+	}
+
+	if(master_flag) {
+		pp_stat_print("ROUND-TRIP", &rtt);
+		pp_stat_print("ONE-WAY", &oneway);
+	} else {
+		printf("PINGPONG: %d of %d packets answered\n", seq - 1, pp_count);
+	}
+
+	return (seq > pp_count) ? 0 : -1;
+}
+
+
 /*
  * main.c
  */
@@ -351,6 +629,22 @@ int main(int argc, char *argv[])
 			case 'S':	master_flag = 0; break;
 			case 'b':
 			case 'B':	board_id = atol(&argv[i][2]); break;
+			case 'n':
+			case 'N':	pp_count = atol(&argv[i][2]); break;
+			case 'z':
+			case 'Z':	pp_size = atol(&argv[i][2]); break;
+			case 'x':
+			case 'X':
+				switch(argv[i][2]) {
+				case 'p':	pp_mode = PP_MODE_POLL; break;
+				case 'd':	pp_mode = PP_MODE_DOORBELL; break;
+				case 'r':	pp_mode = PP_MODE_NREAD; break;
+				case 'm':
+					printf("Error: Type-11 messages need QMSS/CPPI, not configured in this application\n");
+					return -1;
+				default:	print_usage(); return -1;
+				}
+				break;
 			case 'h':
 			case 'H':
 			case '?':	print_usage(); return 0;
@@ -394,6 +688,20 @@ int main(int argc, char *argv[])
 	if( board_id == 1 ) 		dest_id = DEVICE_ID2_8BIT;
 	else if( board_id == 2 ) 	dest_id = DEVICE_ID1_8BIT;
 
+	if( pp_mode != PP_MODE_NONE ) {
+		if( pp_size < 8 || pp_size > PP_MAX_SIZE || (pp_size & 3) || pp_count <= 0 ) {
+			printf("Error: bad ping-pong size %d or count %d\n", pp_size, pp_count);
+			return -1;
+		}
+		CSL_tscEnable();
+		i = pingpong(dest_id);
+		if(test_flag != 0) {
+			printf(i == 0 ? "OK\n" : "ERROR\n");
+			DZY_exit(0);
+		}
+		return i;
+	}
+
 
 	if( master_flag==1) {
 		*((uint32_t *)destination) =  0x11221122;